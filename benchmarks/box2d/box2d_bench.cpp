@@ -23,7 +23,10 @@ typedef struct {
 } result_t;
 // ==============================
 
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <time.h>
 #include <math.h>
 
@@ -41,7 +44,393 @@ typedef struct {
 
 using namespace std;
 
-const int e_count = 40;
+b2World *world;
+b2Body* topBody;
+
+// With the stages option, b2Profile fields are streamed as progress on work items of the same
+// name, counting the milliseconds spent in each stage. They are flushed together with the
+// "steps" progress.
+bool record_stages = false;
+struct stage_t {
+  const char* name;
+  float32 b2Profile::*time;
+};
+
+const stage_t stages[] = {
+  {"step", &b2Profile::step},
+  {"collide", &b2Profile::collide},
+  {"solve", &b2Profile::solve},
+  {"solveInit", &b2Profile::solveInit},
+  {"solveVelocity", &b2Profile::solveVelocity},
+  {"solvePosition", &b2Profile::solvePosition},
+  {"broadphase", &b2Profile::broadphase},
+  {"solveTOI", &b2Profile::solveTOI},
+};
+const int stage_count = sizeof(stages) / sizeof(stages[0]);
+float stage_times[stage_count];
+
+void accumulate_stages() {
+  if (!record_stages)
+    return;
+  const b2Profile& profile = world->GetProfile();
+  for (int i = 0; i < stage_count; ++i)
+    stage_times[i] += profile.*stages[i].time;
+}
+
+void flush_stages() {
+  if (!record_stages)
+    return;
+  for (int i = 0; i < stage_count; ++i) {
+    wasm_perf_record_relative_progress(stages[i].name, stage_times[i]);
+    stage_times[i] = 0;
+  }
+}
+
+// Scenes ======================
+// Every scene creates its static geometry and about the requested number of dynamic bodies and
+// returns how many it actually created.
+
+// Deterministic pseudo random numbers in [lo, hi), so that all environments simulate the same world.
+uint32 seed = 42;
+
+float32 randomFloat(float32 lo, float32 hi) {
+  seed = seed * 1664525u + 1013904223u;
+  return lo + (hi - lo) * float32(seed >> 8) / float32(1u << 24);
+}
+
+// Long static geometry is split into one body per segment: b2ContactManager::AddPair walks the
+// whole contact list of a body, which makes a single ground body touching every other body
+// quadratic in the body count.
+const int segmentWidth = 20;
+
+void createGround(float32 halfWidth, bool walls) {
+  b2EdgeShape shape;
+  for (float32 x = -halfWidth; x < halfWidth; x += segmentWidth) {
+    b2BodyDef bd;
+    b2Body* ground = world->CreateBody(&bd);
+    shape.Set(b2Vec2(x, 0.0f), b2Vec2(b2Min(x + segmentWidth, halfWidth), 0.0f));
+    ground->CreateFixture(&shape, 0.0f);
+  }
+  if (walls) {
+    b2BodyDef bd;
+    b2Body* ground = world->CreateBody(&bd);
+    const float32 height = b2Max(40.0f, 0.1f * halfWidth);
+    shape.Set(b2Vec2(-halfWidth, 0.0f), b2Vec2(-halfWidth, height));
+    ground->CreateFixture(&shape, 0.0f);
+    shape.Set(b2Vec2(halfWidth, 0.0f), b2Vec2(halfWidth, height));
+    ground->CreateFixture(&shape, 0.0f);
+  }
+}
+
+b2Body* createDynamic(const b2Vec2& position, const b2Shape& shape, float32 density) {
+  b2BodyDef bd;
+  bd.type = b2_dynamicBody;
+  bd.position = position;
+  b2Body* body = world->CreateBody(&bd);
+  body->CreateFixture(&shape, density);
+  topBody = body;
+  return body;
+}
+
+// Boxes, circles and triangles of varying size dropped onto the ground in a jittered grid.
+int dropMixedShapes(int count, float32 halfWidth, float32 bottom) {
+  const int columns = int(2.0f * halfWidth / 1.5f) - 1;
+  for (int i = 0; i < count; ++i) {
+    b2Vec2 position(-halfWidth + 1.5f * (i % columns + 1) + randomFloat(-0.2f, 0.2f), bottom + 1.5f * (i / columns) + randomFloat(0.0f, 0.5f));
+    float32 size = randomFloat(0.25f, 0.6f);
+    switch (i % 3) {
+      case 0: {
+        b2PolygonShape shape;
+        shape.SetAsBox(size, size * randomFloat(0.5f, 1.0f));
+        createDynamic(position, shape, 5.0f);
+        break;
+      }
+      case 1: {
+        b2CircleShape shape;
+        shape.m_radius = size;
+        createDynamic(position, shape, 5.0f);
+        break;
+      }
+      case 2: {
+        b2Vec2 vertices[3] = {b2Vec2(-size, 0.0f), b2Vec2(size, 0.0f), b2Vec2(0.0f, 2.0f * size)};
+        b2PolygonShape shape;
+        shape.Set(vertices, 3);
+        createDynamic(position, shape, 5.0f);
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+// The classic bench2d pyramid, 40 rows and 820 boxes by default.
+int createPyramid(int count) {
+  int rows = 1;
+  while ((rows + 1) * (rows + 2) / 2 <= count)
+    ++rows;
+
+  if (rows <= 40) {
+    // the single ground edge of bench2d, so that the default pyramid stays the historical scene
+    b2BodyDef bd;
+    b2Body* ground = world->CreateBody(&bd);
+    b2EdgeShape shape;
+    shape.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+    ground->CreateFixture(&shape, 0.0f);
+  } else {
+    createGround(1.125f * rows, false);
+  }
+
+	{
+		float32 a = 0.5f;
+		b2PolygonShape shape;
+		shape.SetAsBox(a, a);
+
+		b2Vec2 x(-0.5625f * rows + 15.5f, 0.75f);
+		b2Vec2 y;
+		b2Vec2 deltaX(0.5625f, 1);
+		b2Vec2 deltaY(1.125f, 0.0f);
+
+		for (int32 i = 0; i < rows; ++i) {
+			y = x;
+
+			for (int32 j = i; j < rows; ++j) {
+				createDynamic(y, shape, 5.0f);
+
+				y += deltaY;
+			}
+
+			x += deltaX;
+		}
+	}
+  return rows * (rows + 1) / 2;
+}
+
+// Mixed shapes raining into a container.
+int createRain(int count) {
+  const float32 halfWidth = b2Max(20.0f, count / 20.0f);
+  createGround(halfWidth, true);
+  return dropMixedShapes(count, halfWidth, 2.0f);
+}
+
+// Chains of ten links hanging from the ceiling, alternating with ragdolls of six bodies
+// connected by revolute joints with limits.
+int createChains(int count) {
+  const int units = b2Max(1, count / 8);
+  const float32 spacing = 4.0f;
+  const float32 halfWidth = 0.5f * spacing * (units + 1);
+  createGround(halfWidth, false);
+
+  b2RevoluteJointDef jd;
+  int created = 0;
+  for (int unit = 0; unit < units; ++unit) {
+    const float32 x = -halfWidth + spacing * (unit + 1);
+    if (unit % 2 == 0) {
+      const float32 top = 25.0f;
+      b2PolygonShape shape;
+      shape.SetAsBox(0.5f, 0.125f);
+      b2BodyDef bd;
+      bd.position.Set(x, top);
+      b2Body* previous = world->CreateBody(&bd);
+      jd.enableLimit = false;
+      for (int link = 0; link < 10; ++link) {
+        b2Body* body = createDynamic(b2Vec2(x + 0.5f + link, top), shape, 20.0f);
+        jd.Initialize(previous, body, b2Vec2(x + link, top));
+        world->CreateJoint(&jd);
+        previous = body;
+      }
+      created += 10;
+    } else {
+      const float32 bottom = 2.0f + randomFloat(0.0f, 8.0f);
+      b2PolygonShape torsoShape, limbShape;
+      torsoShape.SetAsBox(0.3f, 0.6f);
+      limbShape.SetAsBox(0.1f, 0.4f);
+      b2CircleShape headShape;
+      headShape.m_radius = 0.25f;
+      b2Body* torso = createDynamic(b2Vec2(x, bottom + 1.4f), torsoShape, 5.0f);
+      b2Body* parts[5] = {
+        createDynamic(b2Vec2(x, bottom + 2.25f), headShape, 5.0f),
+        createDynamic(b2Vec2(x - 0.45f, bottom + 1.5f), limbShape, 5.0f),
+        createDynamic(b2Vec2(x + 0.45f, bottom + 1.5f), limbShape, 5.0f),
+        createDynamic(b2Vec2(x - 0.2f, bottom + 0.4f), limbShape, 5.0f),
+        createDynamic(b2Vec2(x + 0.2f, bottom + 0.4f), limbShape, 5.0f),
+      };
+      const b2Vec2 anchors[5] = {
+        b2Vec2(x, bottom + 2.0f), b2Vec2(x - 0.3f, bottom + 1.9f), b2Vec2(x + 0.3f, bottom + 1.9f),
+        b2Vec2(x - 0.2f, bottom + 0.8f), b2Vec2(x + 0.2f, bottom + 0.8f),
+      };
+      jd.enableLimit = true;
+      jd.lowerAngle = -0.25f * b2_pi;
+      jd.upperAngle = 0.25f * b2_pi;
+      for (int part = 0; part < 5; ++part) {
+        jd.Initialize(torso, parts[part], anchors[part]);
+        world->CreateJoint(&jd);
+      }
+      created += 6;
+    }
+  }
+  return created;
+}
+
+// Mixed shapes falling onto a hilly terrain of chain shapes.
+int createTerrain(int count) {
+  const float32 halfWidth = b2Max(40.0f, count / 20.0f);
+  const int vertexCount = segmentWidth + 1;
+  b2Vec2 vertices[vertexCount];
+  for (float32 left = -halfWidth; left < halfWidth; left += segmentWidth) {
+    for (int i = 0; i < vertexCount; ++i) {
+      const float32 x = left + i;
+      vertices[i].Set(x, 3.0f + 2.0f * sinf(0.1f * x) + 0.5f * sinf(0.37f * x) + 0.25f * cosf(1.3f * x));
+    }
+    b2BodyDef bd;
+    b2Body* ground = world->CreateBody(&bd);
+    b2ChainShape shape;
+    shape.CreateChain(vertices, vertexCount);
+    ground->CreateFixture(&shape, 0.0f);
+  }
+
+  createGround(halfWidth, true);
+  return dropMixedShapes(count, halfWidth, 7.0f);
+}
+
+// Half of the bodies are small, fast bullets shot into stacks of thin boxes, which keeps the
+// continuous collision detection in SolveTOI busy.
+int createBullets(int count) {
+  const int stacks = b2Max(1, count / 40);
+  const float32 halfWidth = b2Max(20.0f, 2.0f * stacks);
+  createGround(halfWidth, true);
+
+  int created = 0;
+  b2PolygonShape plank;
+  plank.SetAsBox(0.1f, 0.5f);
+  for (int i = 0; i < count / 2; ++i) {
+    createDynamic(b2Vec2(-halfWidth + 4.0f * (i % stacks) + 2.0f, 0.5f + 1.05f * (i / stacks)), plank, 5.0f);
+    ++created;
+  }
+  b2CircleShape bulletShape;
+  bulletShape.m_radius = 0.05f;
+  for (int i = created; i < count; ++i) {
+    b2Body* body = createDynamic(b2Vec2(randomFloat(-halfWidth + 1.0f, halfWidth - 1.0f), randomFloat(1.0f, 20.0f)), bulletShape, 20.0f);
+    body->SetBullet(true);
+    body->SetLinearVelocity(b2Vec2(randomFloat(-150.0f, 150.0f), randomFloat(-50.0f, 50.0f)));
+    ++created;
+  }
+  return created;
+}
+
+typedef struct {
+  const char* name;
+  int (*create)(int count);
+} scene_t;
+
+const scene_t scenes[] = {
+  {"pyramid", createPyramid},
+  {"rain", createRain},
+  {"chains", createChains},
+  {"terrain", createTerrain},
+  {"bullets", createBullets},
+};
+// ==============================
+
+// Broadphase only ==============
+// Random boxes in a square that keeps the density constant, about a tenth of them moving every
+// frame. This runs b2BroadPhase::UpdatePairs without the rest of the step, so the queries for
+// moved proxies are all that is measured. The tree is either built incrementally as in
+// b2World, or rebuilt with the surface area heuristic every rebuildInterval frames.
+const int rebuildInterval = 16;
+
+struct pair_counter_t {
+  int pairs;
+  uint32_t checksum;
+
+  void AddPair(void* userDataA, void* userDataB) {
+    const uint32_t a = uint32_t(reinterpret_cast<uintptr_t>(userDataA));
+    const uint32_t b = uint32_t(reinterpret_cast<uintptr_t>(userDataB));
+    ++pairs;
+    checksum = (checksum ^ (b2Min(a, b) * 65536u + b2Max(a, b))) * 16777619u;
+  }
+};
+
+// Options: tree=incremental (default) or tree=sah, reorder to put the internal tree nodes
+// into depth first order after building, query=single (default) or query=batch
+int runBroadphase(int proxies, int argc, char** argv) {
+  bool sah = false;
+  bool reorder = false;
+  bool batch = false;
+  for (int i = 4; i < argc; ++i) {
+    if (strcmp(argv[i], "tree=incremental") == 0 || strcmp(argv[i], "tree=sah") == 0) {
+      sah = strcmp(argv[i] + 5, "sah") == 0;
+    } else if (strcmp(argv[i], "reorder") == 0) {
+      reorder = true;
+    } else if (strcmp(argv[i], "query=single") == 0 || strcmp(argv[i], "query=batch") == 0) {
+      batch = strcmp(argv[i] + 6, "batch") == 0;
+    } else {
+      printf("error: unknown option %s\n", argv[i]);
+      return -1;
+    }
+  }
+
+  const float32 halfWidth = 1.5f * sqrtf(float32(proxies));
+  b2AABB* aabbs = new b2AABB[proxies];
+  b2Vec2* velocities = new b2Vec2[proxies];
+  int32* ids = new int32[proxies];
+  b2BroadPhase broadPhase;
+  broadPhase.SetBatchedQueries(batch);
+  for (int i = 0; i < proxies; ++i) {
+    b2Vec2 center(randomFloat(-halfWidth, halfWidth), randomFloat(-halfWidth, halfWidth));
+    b2Vec2 extents(randomFloat(0.1f, 1.0f), randomFloat(0.1f, 1.0f));
+    aabbs[i].lowerBound = center - extents;
+    aabbs[i].upperBound = center + extents;
+    velocities[i].Set(randomFloat(-0.5f, 0.5f), randomFloat(-0.5f, 0.5f));
+    ids[i] = broadPhase.CreateProxy(aabbs[i], reinterpret_cast<void*>(uintptr_t(i)));
+  }
+
+  pair_counter_t counter = {0, 2166136261u};
+  uint64_t rebuilds = 0;
+  int queries = 0;
+  wasm_perf_record_relative_progress("queries", 0);
+  for (int frame = 0; frame < FRAMES; ++frame) {
+    if (frame % rebuildInterval == 0 && (sah || reorder)) {
+      wasm_perf_mark_begin("rebuild", rebuilds);
+      if (sah)
+        broadPhase.RebuildTree();
+      if (reorder)
+        broadPhase.ReorderTree();
+      wasm_perf_mark_end("rebuild", rebuilds);
+      ++rebuilds;
+    }
+
+    for (int i = 0; i < proxies / 10; ++i) {
+      const int index = int(randomFloat(0.0f, float32(proxies)));
+      b2Vec2 displacement = velocities[index];
+      const b2Vec2 center = aabbs[index].GetCenter() + displacement;
+      if (b2Abs(center.x) > halfWidth)
+        velocities[index].x = -velocities[index].x;
+      if (b2Abs(center.y) > halfWidth)
+        velocities[index].y = -velocities[index].y;
+      aabbs[index].lowerBound += displacement;
+      aabbs[index].upperBound += displacement;
+      broadPhase.MoveProxy(ids[index], aabbs[index], displacement);
+      ++queries;
+    }
+
+    broadPhase.UpdatePairs(&counter);
+
+    if ((frame & 0xf) == 0xf) {
+      wasm_perf_record_relative_progress("queries", float(queries));
+      queries = 0;
+    }
+  }
+  wasm_perf_record_relative_progress("queries", float(queries));
+
+  printf("broadphase: %d proxies, tree height %d, quality %.3f\n", proxies, broadPhase.GetTreeHeight(), broadPhase.GetTreeQuality());
+  printf("pairs: %d, checksum %08x\n", counter.pairs, counter.checksum);
+
+  delete[] ids;
+  delete[] velocities;
+  delete[] aabbs;
+  return 0;
+}
+// ==============================
 
 result_t measure(clock_t *times) {
   float values[FRAMES];
@@ -64,9 +453,7 @@ result_t measure(clock_t *times) {
   return r;
 }
 
-b2World *world;
 clock_t *times, minn = CLOCKS_PER_SEC * 1000 * 100, maxx = -1;
-b2Body* topBody;
 int32 frameCounter = 0;
 
 void iter();
@@ -83,10 +470,70 @@ int main(int argc, char **argv) {
     default: printf("error: %d\\n", arg); return -1;
   }
 
+  // Optional scene (pyramid, rain, chains, terrain or bullets) and number of dynamic bodies, or
+  // broadphase and the number of proxies
+  if (argc > 2 && strcmp(argv[2], "broadphase") == 0) {
+    int proxies = argc > 3 ? atoi(argv[3]) : 10000;
+    if (proxies <= 0) {
+      printf("error: invalid proxy count %s\n", argv[3]);
+      return -1;
+    }
+    return runBroadphase(proxies, argc, argv);
+  }
+  const scene_t* scene = &scenes[0];
+  if (argc > 2) {
+    scene = NULL;
+    for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); ++i) {
+      if (strcmp(argv[2], scenes[i].name) == 0)
+        scene = &scenes[i];
+    }
+    if (scene == NULL) {
+      printf("error: unknown scene %s\n", argv[2]);
+      return -1;
+    }
+  }
+  int bodies = argc > 3 ? atoi(argv[3]) : 820;
+  if (bodies <= 0) {
+    printf("error: invalid body count %s\n", argv[3]);
+    return -1;
+  }
+  // Options: sleep or nosleep (default), continuous (default) or discrete, threads=<count>,
+  // solver=scalar (default) or solver=simd, drift to replay the scene with the scalar solver
+  // afterwards and print how far the final body states are apart, query=single (default) or
+  // query=batch for the broad-phase, stages to stream the b2Profile stages
+  bool allow_sleeping = false;
+  bool continuous = true;
+  int threads = 1;
+  bool simd_solver = false;
+  bool drift = false;
+  bool batch_queries = false;
+  for (int i = 4; i < argc; ++i) {
+    if (strcmp(argv[i], "sleep") == 0 || strcmp(argv[i], "nosleep") == 0) {
+      allow_sleeping = argv[i][0] == 's';
+    } else if (strcmp(argv[i], "continuous") == 0 || strcmp(argv[i], "discrete") == 0) {
+      continuous = argv[i][0] == 'c';
+    } else if (strncmp(argv[i], "threads=", 8) == 0 && atoi(argv[i] + 8) > 0) {
+      threads = atoi(argv[i] + 8);
+    } else if (strcmp(argv[i], "solver=scalar") == 0 || strcmp(argv[i], "solver=simd") == 0) {
+      simd_solver = strcmp(argv[i] + 7, "simd") == 0;
+    } else if (strcmp(argv[i], "drift") == 0) {
+      drift = true;
+    } else if (strcmp(argv[i], "query=single") == 0 || strcmp(argv[i], "query=batch") == 0) {
+      batch_queries = strcmp(argv[i] + 6, "batch") == 0;
+    } else if (strcmp(argv[i], "stages") == 0) {
+      record_stages = true;
+    } else {
+      printf("error: unknown option %s\n", argv[i]);
+      return -1;
+    }
+  }
+
   // do not split out warmup, do not ignore initial stalls
   FRAMES += WARMUP;
   WARMUP = 0;
 
+  b2Timer::SetEnabled(record_stages);
+
   times = new clock_t[FRAMES];
 
 	// Define the gravity vector.
@@ -94,58 +541,63 @@ int main(int argc, char **argv) {
 
 	// Construct a world object, which will hold and simulate the rigid bodies.
 	world = new b2World(gravity);
-  world->SetAllowSleeping(false);
-
-	{
-		b2BodyDef bd;
-		b2Body* ground = world->CreateBody(&bd);
-
-		b2EdgeShape shape;
-		shape.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
-		ground->CreateFixture(&shape, 0.0f);
-	}
-
-	{
-		float32 a = 0.5f;
-		b2PolygonShape shape;
-		shape.SetAsBox(a, a);
-
-		b2Vec2 x(-7.0f, 0.75f);
-		b2Vec2 y;
-		b2Vec2 deltaX(0.5625f, 1);
-		b2Vec2 deltaY(1.125f, 0.0f);
-
-		for (int32 i = 0; i < e_count; ++i) {
-			y = x;
+  world->SetAllowSleeping(allow_sleeping);
+  world->SetContinuousPhysics(continuous);
+  world->SetThreadCount(threads);
+  world->SetSIMDContactSolver(simd_solver);
+  world->SetBatchedBroadPhaseQueries(batch_queries);
 
-			for (int32 j = i; j < e_count; ++j) {
-				b2BodyDef bd;
-				bd.type = b2_dynamicBody;
-				bd.position = y;
-				b2Body* body = world->CreateBody(&bd);
-				body->CreateFixture(&shape, 5.0f);
-
-        topBody = body;
-
-				y += deltaY;
-			}
-
-			x += deltaX;
-		}
-	}
+  int created = scene->create(bodies);
+  printf("%s: %d bodies\n", scene->name, created);
 
 	for (int32 i = 0; i < WARMUP; ++i) {
 		world->Step(1.0f/60.0f, 3, 3);
   }
 
   wasm_perf_record_relative_progress("steps", 0);
+  flush_stages();
   do {
     iter();
   } while (frameCounter <= FRAMES);
 
+  if (drift) {
+    // Same scene and steps with the scalar solver. Bodies are created in the same order, so the
+    // body lists of both worlds match up.
+    b2World* measured = world;
+    world = new b2World(gravity);
+    world->SetAllowSleeping(allow_sleeping);
+    world->SetContinuousPhysics(continuous);
+    seed = 42;
+    scene->create(bodies);
+    for (int32 i = 0; i < FRAMES; ++i) {
+      world->Step(1.0f/60.0f, 3, 3);
+    }
+    float32 max_position = 0.0f;
+    float32 max_angle = 0.0f;
+    for (b2Body *a = measured->GetBodyList(), *b = world->GetBodyList(); a && b; a = a->GetNext(), b = b->GetNext()) {
+      max_position = b2Max(max_position, b2Distance(a->GetPosition(), b->GetPosition()));
+      max_angle = b2Max(max_angle, b2Abs(a->GetAngle() - b->GetAngle()));
+    }
+    printf("drift: max position %.6f, max angle %.6f\n", fabsf(max_position), fabsf(max_angle));
+  }
+
   return 0;
 }
 
+// FNV-1a over the bit patterns of all body positions and angles. Solver variants that claim
+// identical results have to print the same hash.
+uint32_t hash_world() {
+  uint32_t hash = 2166136261u;
+  for (b2Body* body = world->GetBodyList(); body; body = body->GetNext()) {
+    float32 state[3] = {body->GetPosition().x, body->GetPosition().y, body->GetAngle()};
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(state);
+    for (size_t i = 0; i < sizeof(state); ++i) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  }
+  return hash;
+}
+
 void iter() {
   if (frameCounter < FRAMES) {
 	  clock_t start = clock();
@@ -159,9 +611,12 @@ void iter() {
     printf("%f :: ", topBody->GetPosition().y);
 	  printf("%f\n", (float32)(end - start) / CLOCKS_PER_SEC * 1000);
 #endif
+    accumulate_stages();
     frameCounter++;
-    if ((frameCounter & 0xfu) == 0)
+    if ((frameCounter & 0xfu) == 0) {
       wasm_perf_record_relative_progress("steps", 0x10u);
+      flush_stages();
+    }
     return;
   }
 
@@ -172,5 +627,6 @@ void iter() {
   result_t result = measure(times);
 
   printf("frame averages: %.3f +- %.3f, range: %.3f to %.3f \n", result.mean, result.stddev, float(minn)/CLOCKS_PER_SEC * 1000, float(maxx)/CLOCKS_PER_SEC * 1000);
+  printf("world hash: %08x\n", hash_world());
 }
 
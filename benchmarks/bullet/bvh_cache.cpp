@@ -0,0 +1,20 @@
+// Writes the serialized landscape BVHs that bullet_bench maps with bvh=cache. The cache is only
+// valid for the pointer size and btQuantizedBvh layout it was built with, so the build runs this
+// on the target platform: natively, or for Wasm under node with the host file system.
+//
+//   bvh_cache <path>
+
+#include <stdio.h>
+#include "BenchmarkDemo.h"
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("usage: %s <path>\n", argv[0]);
+    return -1;
+  }
+  if (!writeLandscapeBvhCache(argv[1])) {
+    printf("error: cannot write the BVH cache %s\n", argv[1]);
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,289 @@
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "wasm_perf.h"
+#include "lua_hooks.h"
+
+
+// Every script defines a global function bench(iteration) that performs one unit of work and
+// returns a number which is summed up and printed to keep the work observable.
+typedef struct {
+  const char* name;
+  int iterations;
+  const char* source;
+} Script;
+
+static const Script scripts[] = {
+  {"fib", 20,
+    "local function fib(n)\n"
+    "  if n < 2 then return n end\n"
+    "  return fib(n - 1) + fib(n - 2)\n"
+    "end\n"
+    "function bench(iteration)\n"
+    "  return fib(24 + iteration % 2)\n"
+    "end\n"},
+  {"tables", 10,
+    "function bench(iteration)\n"
+    "  local array = {}\n"
+    "  for i = 1, 20000 do array[i] = (i * 7919 + iteration) % 10007 end\n"
+    "  table.sort(array)\n"
+    "  local hash = {}\n"
+    "  for i = 1, #array, 3 do hash['k' .. array[i]] = i end\n"
+    "  local sum = 0\n"
+    "  for key, value in pairs(hash) do sum = sum + value end\n"
+    "  for i = #array, 1, -2 do table.remove(array) end\n"
+    "  return sum + #array\n"
+    "end\n"},
+  {"strings", 20,
+    "function bench(iteration)\n"
+    "  local parts = {}\n"
+    "  for i = 1, 5000 do\n"
+    "    parts[#parts + 1] = string.format('%d:%s;', i, string.rep('ab', i % 7))\n"
+    "  end\n"
+    "  local text = table.concat(parts)\n"
+    "  local replaced, count = text:gsub('(%d+):(a?b?)', '%2=%1')\n"
+    "  local words = 0\n"
+    "  for word in replaced:gmatch('[^;]+') do words = words + #word end\n"
+    "  local built = ''\n"
+    "  for i = 1, 500 do built = built .. string.char(65 + (i + iteration) % 26) end\n"
+    "  return count + words + #built:upper():lower()\n"
+    "end\n"},
+  {"closures", 50,
+    "local function counter(step)\n"
+    "  local value = 0\n"
+    "  return function() value = value + step; return value end\n"
+    "end\n"
+    "local function generator(limit)\n"
+    "  return coroutine.wrap(function()\n"
+    "    for i = 1, limit do coroutine.yield(i) end\n"
+    "  end)\n"
+    "end\n"
+    "function bench(iteration)\n"
+    "  local sum = 0\n"
+    "  for i = 1, 200 do\n"
+    "    local next_value = counter(i)\n"
+    "    for j = 1, 50 do sum = sum + next_value() end\n"
+    "  end\n"
+    "  for i = 1, 20 do\n"
+    "    for value in generator(500) do sum = sum + value end\n"
+    "  end\n"
+    "  return sum % 1000003 + iteration\n"
+    "end\n"},
+  {"gc", 10,
+    "local live = {}\n"
+    "function bench(iteration)\n"
+    "  local sum = 0\n"
+    "  for i = 1, 20000 do\n"
+    "    local node = {value = i, name = 'node' .. (i % 100), children = {i, i + 1}}\n"
+    "    if i % 16 == 0 then live[math.floor(i / 16) % 256 + 1] = node end\n"
+    "    sum = sum + #node.children\n"
+    "  end\n"
+    "  return sum + #live + iteration\n"
+    "end\n"},
+};
+
+
+// Collector steps are reported as "gc_step" intervals when tracing is enabled.
+static int trace_gc = 0;
+static uint64_t gc_steps = 0;
+
+void lua_bench_gc_step_begin(struct lua_State* L) {
+  if (trace_gc)
+    wasm_perf_mark_begin("gc_step", gc_steps);
+}
+
+void lua_bench_gc_step_end(struct lua_State* L) {
+  if (trace_gc)
+    wasm_perf_mark_end("gc_step", gc_steps);
+  ++gc_steps;
+}
+
+
+// Pooled lua_Alloc: blocks of up to POOL_MAX_SIZE bytes are rounded up to a multiple of
+// POOL_GRANULARITY and served from per size class free lists, which are refilled from larger
+// chunks. Chunks are only released in pool_destroy(). Larger blocks go to malloc.
+#define POOL_GRANULARITY 16
+#define POOL_MAX_SIZE 256
+#define POOL_CLASSES (POOL_MAX_SIZE / POOL_GRANULARITY)
+#define POOL_CHUNK_SIZE (64 * 1024)
+
+typedef struct PoolBlock {
+  struct PoolBlock* next;
+} PoolBlock;
+
+typedef struct PoolChunk {
+  struct PoolChunk* next;
+} PoolChunk;
+
+typedef struct {
+  PoolBlock* free_lists[POOL_CLASSES];
+  PoolChunk* chunks;
+} Pool;
+
+static void* pool_get(Pool* pool, size_t size_class) {
+  PoolBlock* block = pool->free_lists[size_class];
+  if (block == NULL) {
+    // Carve a new chunk into blocks of this size class.
+    const size_t block_size = (size_class + 1) * POOL_GRANULARITY;
+    const size_t header_size = (sizeof(PoolChunk) + POOL_GRANULARITY - 1) / POOL_GRANULARITY * POOL_GRANULARITY;
+    PoolChunk* chunk = (PoolChunk*)malloc(POOL_CHUNK_SIZE);
+    if (chunk == NULL)
+      return NULL;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    for (size_t offset = header_size; offset + block_size <= POOL_CHUNK_SIZE; offset += block_size) {
+      PoolBlock* new_block = (PoolBlock*)((char*)chunk + offset);
+      new_block->next = block;
+      block = new_block;
+    }
+  }
+  pool->free_lists[size_class] = block->next;
+  return block;
+}
+
+static void pool_put(Pool* pool, void* ptr, size_t size_class) {
+  PoolBlock* block = (PoolBlock*)ptr;
+  block->next = pool->free_lists[size_class];
+  pool->free_lists[size_class] = block;
+}
+
+static void* pool_alloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+  Pool* pool = (Pool*)ud;
+  // Without a block Lua passes the object type in osize.
+  if (ptr == NULL)
+    osize = 0;
+  const int old_pooled = osize > 0 && osize <= POOL_MAX_SIZE;
+  const int new_pooled = nsize > 0 && nsize <= POOL_MAX_SIZE;
+  const size_t old_class = (osize - 1) / POOL_GRANULARITY;
+  const size_t new_class = (nsize - 1) / POOL_GRANULARITY;
+  if (nsize == 0) {
+    if (old_pooled)
+      pool_put(pool, ptr, old_class);
+    else
+      free(ptr);
+    return NULL;
+  }
+  if (!old_pooled && !new_pooled)
+    return realloc(ptr, nsize);
+  if (old_pooled && new_pooled && old_class == new_class)
+    return ptr;
+  void* new_ptr = new_pooled ? pool_get(pool, new_class) : malloc(nsize);
+  if (new_ptr == NULL)
+    return NULL;
+  if (ptr != NULL) {
+    memcpy(new_ptr, ptr, osize < nsize ? osize : nsize);
+    if (old_pooled)
+      pool_put(pool, ptr, old_class);
+    else
+      free(ptr);
+  }
+  return new_ptr;
+}
+
+static void pool_destroy(Pool* pool) {
+  while (pool->chunks != NULL) {
+    PoolChunk* chunk = pool->chunks;
+    pool->chunks = chunk->next;
+    free(chunk);
+  }
+}
+
+
+static const Script* find_script(const char* name) {
+  for (size_t index = 0; index < sizeof(scripts) / sizeof(scripts[0]); ++index) {
+    if (strcmp(scripts[index].name, name) == 0)
+      return &scripts[index];
+  }
+  return NULL;
+}
+
+// don't inline, to be friendly to js engine osr
+static double __attribute__ ((noinline)) run_iteration(lua_State* L, int iteration) {
+  double result;
+  lua_getglobal(L, "bench");
+  lua_pushinteger(L, iteration);
+  if (lua_pcall(L, 1, 1, 0) != LUA_OK) {
+    printf("error: %s\n", lua_tostring(L, -1));
+    exit(1);
+  }
+  result = lua_tonumber(L, -1);
+  lua_pop(L, 1);
+  return result;
+}
+
+int main(int argc, char **argv) {
+  const Script* script = find_script(argc > 1 ? argv[1] : "fib");
+  if (script == NULL) {
+    printf("error: unknown script %s\n", argv[1]);
+    return -1;
+  }
+  int factor;
+  int arg = argc > 2 ? argv[2][0] - '0' : 3;
+  switch(arg) {
+    case 0: return 0; break;
+    case 1: factor = 1; break;
+    case 2: factor = 5; break;
+    case 3: factor = 10; break;
+    case 4: factor = 25; break;
+    case 5: factor = 50; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+  int iterations = script->iterations * factor;
+
+  // Collector and allocator options: inc, gen, pause=<percent>, stepmul=<percent>, pool, trace
+  int generational = 0;
+  int pause = -1;
+  int stepmul = -1;
+  int use_pool = 0;
+  for (int index = 3; index < argc; ++index) {
+    if (strcmp(argv[index], "inc") == 0) {
+      generational = 0;
+    } else if (strcmp(argv[index], "gen") == 0) {
+      generational = 1;
+    } else if (strncmp(argv[index], "pause=", 6) == 0) {
+      pause = atoi(argv[index] + 6);
+    } else if (strncmp(argv[index], "stepmul=", 8) == 0) {
+      stepmul = atoi(argv[index] + 8);
+    } else if (strcmp(argv[index], "pool") == 0) {
+      use_pool = 1;
+    } else if (strcmp(argv[index], "trace") == 0) {
+      trace_gc = 1;
+    } else {
+      printf("error: unknown option %s\n", argv[index]);
+      return -1;
+    }
+  }
+
+  Pool pool;
+  memset(&pool, 0, sizeof(pool));
+  lua_State* L = use_pool ? lua_newstate(pool_alloc, &pool) : luaL_newstate();
+  luaL_openlibs(L);
+  lua_gc(L, generational ? LUA_GCGEN : LUA_GCINC, 0);
+  if (pause >= 0)
+    lua_gc(L, LUA_GCSETPAUSE, pause);
+  if (stepmul >= 0)
+    lua_gc(L, LUA_GCSETSTEPMUL, stepmul);
+  if (luaL_dostring(L, script->source) != LUA_OK) {
+    printf("error: %s\n", lua_tostring(L, -1));
+    return 1;
+  }
+
+  double sum = 0.0;
+  for (int i = 0; i < iterations; i++) {
+    wasm_perf_record_progress(script->name, i);
+    sum += run_iteration(L, i);
+  }
+  wasm_perf_record_progress(script->name, iterations);
+  printf("%s: %.0f\n", script->name, sum);
+
+  printf("gc steps: %llu\n", (unsigned long long)gc_steps);
+
+  lua_close(L);
+  pool_destroy(&pool);
+  printf("ok.\n");
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef __LUA_HOOKS_H__
+#define __LUA_HOOKS_H__
+
+// Force-included into every Lua source file to hook the interpreter's luai_* customization
+// points. The hooks are implemented in lua_bench.c.
+
+struct lua_State;
+
+void lua_bench_gc_step_begin(struct lua_State* L);
+void lua_bench_gc_step_end(struct lua_State* L);
+
+#define luai_gcstepbegin(L) lua_bench_gc_step_begin(L)
+#define luai_gcstepend(L) lua_bench_gc_step_end(L)
+
+#endif // __LUA_HOOKS_H__
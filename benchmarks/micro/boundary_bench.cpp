@@ -0,0 +1,89 @@
+// Cost of calls crossing the boundary between Wasm and JS for different argument shapes. The
+// native build calls non-inlined C++ functions with the same signatures as a baseline.
+//
+// Shapes: void, i32, i32x4, f64x4, string (JS decodes a C string), reentrant (Wasm -> JS -> Wasm)
+// and recorder (a wasm_perf call, which goes through the configured recorder bridge).
+
+#include <stdlib.h>
+#include <string.h>
+#include "wasm_perf.h"
+
+extern "C" int EMSCRIPTEN_KEEPALIVE boundary_callback(int value) {
+  return value ^ 0x5bd1e995;
+}
+
+#ifdef __EMSCRIPTEN__
+
+EM_JS(void, call_void, (), {});
+EM_JS(int, call_i32, (int a), { return a + 1; });
+EM_JS(int, call_i32x4, (int a, int b, int c, int d), { return a + b + c + d; });
+EM_JS(double, call_f64x4, (double a, double b, double c, double d), { return a + b + c + d; });
+EM_JS(int, call_string, (const char* string), { return UTF8ToString(string).length; });
+EM_JS(int, call_reentrant, (int a), { return _boundary_callback(a); });
+
+#else // __EMSCRIPTEN__
+
+extern "C" {
+  void __attribute__ ((noinline)) call_void() { __asm__ volatile(""); }
+  int __attribute__ ((noinline)) call_i32(int a) { return a + 1; }
+  int __attribute__ ((noinline)) call_i32x4(int a, int b, int c, int d) { return a + b + c + d; }
+  double __attribute__ ((noinline)) call_f64x4(double a, double b, double c, double d) { return a + b + c + d; }
+  int __attribute__ ((noinline)) call_string(const char* string) { return strlen(string); }
+  int __attribute__ ((noinline)) call_reentrant(int a) { return boundary_callback(a); }
+}
+
+#endif // __EMSCRIPTEN__
+
+int xDoNotRemove = 0;
+double yDoNotRemove = 0.0;
+
+void __attribute__ ((noinline)) run_batch(const char* shape, int calls) {
+  if (strcmp(shape, "void") == 0) {
+    for (int i = 0; i < calls; ++i)
+      call_void();
+  } else if (strcmp(shape, "i32") == 0) {
+    for (int i = 0; i < calls; ++i)
+      xDoNotRemove = call_i32(xDoNotRemove);
+  } else if (strcmp(shape, "i32x4") == 0) {
+    for (int i = 0; i < calls; ++i)
+      xDoNotRemove = call_i32x4(xDoNotRemove, i, 3, 5);
+  } else if (strcmp(shape, "f64x4") == 0) {
+    for (int i = 0; i < calls; ++i)
+      yDoNotRemove = call_f64x4(yDoNotRemove, i, 0.5, -0.25);
+  } else if (strcmp(shape, "string") == 0) {
+    for (int i = 0; i < calls; ++i)
+      xDoNotRemove += call_string("boundary crossing");
+  } else if (strcmp(shape, "reentrant") == 0) {
+    for (int i = 0; i < calls; ++i)
+      xDoNotRemove = call_reentrant(xDoNotRemove);
+  } else if (strcmp(shape, "recorder") == 0) {
+    for (int i = 0; i < calls; ++i)
+      wasm_perf_record_relative_progress("recorder", 1);
+  } else {
+    exit(1);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* shape = argc > 1 ? argv[1] : "void";
+  int batches;
+  int arg = argc > 2 ? argv[2][0] - '0' : 3;
+  switch(arg) {
+    case 0: return 0; break;
+    case 1: batches = 10; break;
+    case 2: batches = 50; break;
+    case 3: batches = 100; break;
+    case 4: batches = 5*100; break;
+    case 5: batches = 10*100; break;
+    default: return -1;
+  }
+  // Recorder calls are far more expensive, especially natively where each one is a write to a pipe.
+  const int batch_size = strcmp(shape, "recorder") == 0 ? 1000 : 100000;
+
+  wasm_perf_record_relative_progress("calls", 0);
+  for (int i = 0; i < batches; i++) {
+    run_batch(shape, batch_size);
+    wasm_perf_record_relative_progress("calls", batch_size / 1000.0f);
+  }
+  return 0;
+}
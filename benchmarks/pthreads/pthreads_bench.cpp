@@ -0,0 +1,95 @@
+// Scaling benchmark for threaded builds. Every thread repeatedly hashes its own buffer and reports
+// each finished pass to the shared "work" progress stream, so the steady-state throughput is
+// separated from the "thread_create" and "thread_startup" intervals recorded while spawning.
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "wasm_perf.h"
+#include "wasm_perf_threads.h"
+
+namespace {
+
+const size_t buffer_size = 1 << 18;
+
+int passes;
+pthread_barrier_t start_barrier;
+
+struct Worker {
+  pthread_t thread;
+  std::vector<uint32_t> buffer;
+  uint32_t checksum;
+};
+
+uint32_t __attribute__ ((noinline)) hash_pass(std::vector<uint32_t>& buffer, uint32_t seed) {
+  uint32_t state = seed;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    buffer[i] += state;
+    state += buffer[(i * 7919) & (buffer.size() - 1)];
+  }
+  return state;
+}
+
+void* run_worker(void* data) {
+  Worker& worker = *static_cast<Worker*>(data);
+  pthread_barrier_wait(&start_barrier);
+  for (int pass = 0; pass < passes; ++pass) {
+    worker.checksum = hash_pass(worker.buffer, worker.checksum);
+    wasm_perf_record_relative_progress("work", 1);
+  }
+  return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int thread_count = argc > 1 ? atoi(argv[1]) : 1;
+  int arg = argc > 2 ? argv[2][0] - '0' : 3;
+  switch(arg) {
+    case 0: return 0; break;
+    case 1: passes = 10; break;
+    case 2: passes = 50; break;
+    case 3: passes = 200; break;
+    case 4: passes = 5*200; break;
+    case 5: passes = 10*200; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+  if (thread_count < 1) {
+    printf("error: invalid thread count %d\n", thread_count);
+    return -1;
+  }
+
+  std::vector<Worker> workers(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    workers[i].buffer.assign(buffer_size, static_cast<uint32_t>(i));
+    workers[i].checksum = 2463534242u + i;
+  }
+
+  wasm_perf_record_relative_progress("work", 0);
+  pthread_barrier_init(&start_barrier, nullptr, thread_count + 1);
+  for (int i = 0; i < thread_count; ++i) {
+    if (wasm_perf_pthread_create(&workers[i].thread, nullptr, run_worker, &workers[i], i) != 0) {
+      printf("error: could not create thread %d\n", i);
+      return -1;
+    }
+  }
+  pthread_barrier_wait(&start_barrier);
+  wasm_perf_mark_event("threads_started");
+
+  uint32_t checksum = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    pthread_join(workers[i].thread, nullptr);
+    checksum ^= workers[i].checksum;
+  }
+  pthread_barrier_destroy(&start_barrier);
+
+  printf("checksum: %08x\n", checksum);
+  printf("ok.\n");
+
+  return 0;
+}
@@ -0,0 +1,269 @@
+// Generates synthetic Wasm modules of a given code size for start-up measurements.
+//
+// Every function has the signature (i32) -> i32 and consists of a deterministic mix of arithmetic,
+// memory and branching snippets. Function 0 is exported as "run" and calls a handful of functions
+// spread over the whole module, directly and through the table, so that a first call has to reach
+// code all over the module.
+
+
+const section_id = {type: 1, function: 3, table: 4, memory: 5, export: 7, element: 9, code: 10};
+
+// Approximate body sizes in bytes for the supported function size distributions.
+const distributions = {
+  small: random => 64,
+  uniform: random => 1024,
+  large: random => 64 * 1024,
+  // Pareto distributed between 32 bytes and 256 KB with most functions being small.
+  mixed: random => Math.min(256 * 1024, Math.floor(32 / Math.pow(1.0 - random(), 1.0 / 1.2))),
+};
+
+
+class ByteWriter {
+  constructor(capacity = 1024) {
+    this.bytes = new Uint8Array(capacity);
+    this.length = 0;
+  }
+
+  reserve(additional) {
+    if (this.length + additional > this.bytes.length) {
+      const bytes = new Uint8Array(Math.max(2 * this.bytes.length, this.length + additional));
+      bytes.set(this.bytes.subarray(0, this.length));
+      this.bytes = bytes;
+    }
+  }
+
+  byte(value) {
+    this.reserve(1);
+    this.bytes[this.length++] = value;
+  }
+
+  raw(bytes) {
+    this.reserve(bytes.length);
+    this.bytes.set(bytes, this.length);
+    this.length += bytes.length;
+  }
+
+  u32(value) {
+    do {
+      let byte = value & 0x7f;
+      value >>>= 7;
+      if (value != 0)
+        byte |= 0x80;
+      this.byte(byte);
+    } while (value != 0);
+  }
+
+  s32(value) {
+    value |= 0;
+    while (true) {
+      const byte = value & 0x7f;
+      value >>= 7;
+      if ((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0)) {
+        this.byte(byte);
+        return;
+      }
+      this.byte(byte | 0x80);
+    }
+  }
+
+  name(string) {
+    this.u32(string.length);
+    for (let i = 0; i < string.length; ++i)
+      this.byte(string.charCodeAt(i));
+  }
+
+  section(id, content) {
+    this.byte(id);
+    this.u32(content.length);
+    this.raw(content.bytes.subarray(0, content.length));
+  }
+
+  result() {
+    return this.bytes.slice(0, this.length);
+  }
+}
+
+
+function xorshift(seed) {
+  let state = seed >>> 0 || 1;
+  return () => {
+    state ^= state << 13;
+    state ^= state >>> 17;
+    state ^= state << 5;
+    state >>>= 0;
+    return state / 4294967296;
+  };
+}
+
+// Emits stack neutral snippets operating on the parameter (local 0) and one scratch local (local 1).
+function emitSnippet(body, random) {
+  const choice = random();
+  const constant = Math.floor(random() * 0x7fffffff);
+  if (choice < 0.6) {
+    // x = ((x * k + c) >> 3) ^ x
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(constant | 1);
+    body.byte(0x6c);
+    body.byte(0x41); body.s32(constant >> 7);
+    body.byte(0x6a);
+    body.byte(0x22); body.u32(1);
+    body.byte(0x41); body.s32(3);
+    body.byte(0x76);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x73);
+    body.byte(0x21); body.u32(0);
+  } else if (choice < 0.8) {
+    // mem[x & 0xfffc] = y; x += mem[(x >> 8) & 0xfffc]
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(0xfffc);
+    body.byte(0x71);
+    body.byte(0x20); body.u32(1);
+    body.byte(0x36); body.u32(2); body.u32(0);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(8);
+    body.byte(0x76);
+    body.byte(0x41); body.s32(0xfffc);
+    body.byte(0x71);
+    body.byte(0x28); body.u32(2); body.u32(0);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x6a);
+    body.byte(0x21); body.u32(0);
+  } else {
+    // if (x & 1) x += c; else x -= c;
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(1);
+    body.byte(0x71);
+    body.byte(0x04); body.byte(0x40);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(constant);
+    body.byte(0x6a);
+    body.byte(0x21); body.u32(0);
+    body.byte(0x05);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(constant);
+    body.byte(0x6b);
+    body.byte(0x21); body.u32(0);
+    body.byte(0x0b);
+  }
+}
+
+function emitFunction(code, target_size, random) {
+  const body = new ByteWriter(target_size + 64);
+  body.raw([0x01, 0x01, 0x7f]);  // One scratch i32 local.
+  while (body.length < target_size)
+    emitSnippet(body, random);
+  body.byte(0x20); body.u32(0);
+  body.byte(0x0b);
+  code.u32(body.length);
+  code.raw(body.bytes.subarray(0, body.length));
+}
+
+function emitRunFunction(code, function_count, table_size) {
+  const body = new ByteWriter();
+  body.u32(0);
+  const direct_calls = Math.min(16, function_count - 1);
+  for (let i = 0; i < direct_calls; ++i) {
+    // x = f(x) + x for functions evenly spread over the module.
+    const callee = 1 + Math.floor(i * (function_count - 1) / direct_calls);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x10); body.u32(callee);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x6a);
+    body.byte(0x21); body.u32(0);
+  }
+  const indirect_calls = table_size > 0 ? 4 : 0;
+  for (let i = 0; i < indirect_calls; ++i) {
+    // x = table[(x + i) % table_size](x) + x
+    body.byte(0x20); body.u32(0);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x41); body.s32(i);
+    body.byte(0x6a);
+    body.byte(0x41); body.s32(table_size);
+    body.byte(0x70);
+    body.byte(0x11); body.u32(0); body.u32(0);
+    body.byte(0x20); body.u32(0);
+    body.byte(0x6a);
+    body.byte(0x21); body.u32(0);
+  }
+  body.byte(0x20); body.u32(0);
+  body.byte(0x0b);
+  code.u32(body.length);
+  code.raw(body.bytes.subarray(0, body.length));
+}
+
+
+// Returns the binary of a module with approximately code_size bytes of function bodies.
+export function generateModule(code_size, distribution = 'uniform', table_size = 0, seed = 42) {
+  const function_size = distributions[distribution];
+  if (function_size === undefined)
+    throw `Unknown function size distribution ${distribution}`;
+  const random = xorshift(seed);
+
+  const code = new ByteWriter(code_size + 1024);
+  const bodies = new ByteWriter(code_size + 1024);
+  let function_count = 1;
+  while (bodies.length < code_size || function_count < 2) {
+    emitFunction(bodies, function_size(random), random);
+    ++function_count;
+  }
+  code.u32(function_count);
+  emitRunFunction(code, function_count, table_size);
+  code.raw(bodies.bytes.subarray(0, bodies.length));
+
+  const module = new ByteWriter(code.length + 1024);
+  module.raw([0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00]);
+
+  const types = new ByteWriter();
+  types.u32(1);
+  types.raw([0x60, 0x01, 0x7f, 0x01, 0x7f]);
+  module.section(section_id.type, types);
+
+  const functions = new ByteWriter(2 * function_count);
+  functions.u32(function_count);
+  for (let i = 0; i < function_count; ++i)
+    functions.u32(0);
+  module.section(section_id.function, functions);
+
+  if (table_size > 0) {
+    const table = new ByteWriter();
+    table.u32(1);
+    table.byte(0x70);
+    table.byte(0x01); table.u32(table_size); table.u32(table_size);
+    module.section(section_id.table, table);
+  }
+
+  const memory = new ByteWriter();
+  memory.u32(1);
+  memory.byte(0x00); memory.u32(1);
+  module.section(section_id.memory, memory);
+
+  const exports = new ByteWriter();
+  exports.u32(2);
+  exports.name('run'); exports.byte(0x00); exports.u32(0);
+  exports.name('memory'); exports.byte(0x02); exports.u32(0);
+  module.section(section_id.export, exports);
+
+  if (table_size > 0) {
+    // Fill the table with every function but "run" itself to avoid recursion.
+    const elements = new ByteWriter(4 * table_size);
+    elements.u32(1);
+    elements.u32(0);
+    elements.byte(0x41); elements.s32(0); elements.byte(0x0b);
+    elements.u32(table_size);
+    for (let i = 0; i < table_size; ++i)
+      elements.u32(1 + i % (function_count - 1));
+    module.section(section_id.element, elements);
+  }
+
+  module.section(section_id.code, code);
+  return module.result();
+}
+
+// Parses sizes like 10K, 1M or 50M into bytes.
+export function parseSize(size) {
+  const match = /^([0-9]+)([KkMm]?)$/.exec(size);
+  if (match === null)
+    throw `Invalid module size ${size}`;
+  const factor = {'': 1, 'k': 1024, 'm': 1024 * 1024}[match[2].toLowerCase()];
+  return parseInt(match[1], 10) * factor;
+}
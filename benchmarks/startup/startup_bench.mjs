@@ -0,0 +1,111 @@
+// Start-up benchmark for large Wasm modules.
+//
+// This file stands in for an Emscripten generated module: the wrapper calls the default export like
+// a MODULARIZE factory and then calls callMain() once per run. Each run compiles and instantiates a
+// synthetic module and records "compile", "instantiate" and "first_call" intervals, followed by a
+// loop of calls reported as the "calls" progress stream from which time-to-peak is derived.
+//
+// Arguments: <mode> <code size> <distribution> <table size> [<calls>]
+//   mode          sync (new WebAssembly.Module), async (WebAssembly.compile), streaming
+//                 (WebAssembly.compileStreaming over a local HTTP server in Node.js or a Response
+//                 elsewhere) or cache (V8 code cache, needs --allow-natives-syntax --no-liftoff
+//                 --no-wasm-lazy-compilation as only fully optimized modules serialize)
+//   code size     total size of all function bodies, e.g. 10K, 1M or 50M
+//   distribution  function body sizes: small, uniform, large or mixed
+//   table size    number of function table entries, 0 for no table
+
+import {generateModule, parseSize} from './module_generator.mjs';
+
+
+const is_node = (typeof process !== 'undefined') && (process.release.name === 'node');
+
+async function compileStreaming(bytes) {
+  if (is_node) {
+    const http = await import('http');
+    const server = http.createServer((request, response) => {
+      response.writeHead(200, {'Content-Type': 'application/wasm', 'Content-Length': bytes.length});
+      response.end(bytes);
+    });
+    await new Promise(resolve => server.listen(0, '127.0.0.1', resolve));
+    try {
+      return await WebAssembly.compileStreaming(fetch(`http://127.0.0.1:${server.address().port}/module.wasm`));
+    } finally {
+      server.close();
+    }
+  } else if (typeof Response !== 'undefined' && typeof WebAssembly.compileStreaming !== 'undefined') {
+    return WebAssembly.compileStreaming(new Response(bytes, {headers: {'Content-Type': 'application/wasm'}}));
+  } else {
+    throw 'Streaming compilation is not supported by this engine';
+  }
+}
+
+// The V8 code cache is only reachable through runtime functions, which are a syntax error unless
+// the engine runs with --allow-natives-syntax.
+function getCodeCache() {
+  try {
+    return {
+      serialize: new Function('module', 'return %SerializeWasmModule(module);'),
+      deserialize: new Function('buffer', 'bytes', 'return %DeserializeWasmModule(buffer, bytes);'),
+    };
+  } catch (error) {
+    throw 'Code caching requires a V8 based engine running with --allow-natives-syntax';
+  }
+}
+
+export default function (options) {
+  const recorder = options.recorder;
+  const mark_begin = (interval, reference) => recorder.ccall('wasm_perf_mark_begin', 'void', ['string', 'int'], [interval, reference]);
+  const mark_end = (interval, reference) => recorder.ccall('wasm_perf_mark_end', 'void', ['string', 'int'], [interval, reference]);
+  const record_relative_progress = (work_item, progress) => recorder.ccall('wasm_perf_record_relative_progress', 'void', ['string', 'float'], [work_item, progress]);
+  let run_index = 0;
+  let code_cache = null;
+
+  return Promise.resolve({
+    callMain: async ([mode = 'sync', size = '1M', distribution = 'uniform', table_size = '0', calls = '2000']) => {
+      const call_count = parseInt(calls, 10);
+      const run = run_index++;
+
+      // Engines may reuse compiled code for identical bytes within a process, so every run but the
+      // code cache ones compiles a different module of the same shape.
+      mark_begin('generate', run);
+      const bytes = generateModule(parseSize(size), distribution, parseInt(table_size, 10), mode == 'cache' ? 42 : 42 + run);
+      mark_end('generate', run);
+
+      let module;
+      if (mode == 'cache' && code_cache === null) {
+        // Populate the cache once outside of the measured intervals.
+        const {serialize, deserialize} = getCodeCache();
+        const cached_module = new WebAssembly.Module(bytes);
+        code_cache = {buffer: serialize(cached_module), deserialize: deserialize};
+      }
+      mark_begin('compile', run);
+      switch (mode) {
+        case 'sync': module = new WebAssembly.Module(bytes); break;
+        case 'async': module = await WebAssembly.compile(bytes); break;
+        case 'streaming': module = await compileStreaming(bytes); break;
+        case 'cache': module = code_cache.deserialize(code_cache.buffer, bytes); break;
+        default: throw `Unknown compilation mode ${mode}`;
+      }
+      mark_end('compile', run);
+      if (module === undefined || module === null)
+        throw 'Could not compile module';
+
+      mark_begin('instantiate', run);
+      const instance = mode == 'sync' || mode == 'cache' ? new WebAssembly.Instance(module) : await WebAssembly.instantiate(module);
+      mark_end('instantiate', run);
+
+      mark_begin('first_call', run);
+      let result = instance.exports.run(run);
+      mark_end('first_call', run);
+
+      record_relative_progress('calls', 0);
+      for (let call = 1; call < call_count; ++call) {
+        result = instance.exports.run(result);
+        if ((call % 20) == 0)
+          record_relative_progress('calls', 20);
+      }
+      options.print(`result: ${result}`);
+      return 0;
+    }
+  });
+}
@@ -0,0 +1,285 @@
+// pigz-style parallel gzip compression, see parallel_deflate.h.
+
+#include "parallel_deflate.h"
+#include "zlib.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DICTIONARY_SIZE 32768
+
+// A compressing thread with its own raw deflate stream, which is kept between blocks and jobs
+// and only initialized again for another level.
+struct worker {
+  parallel_deflate* pool;
+  pthread_t thread;
+  z_stream strm;
+  int level;
+  unsigned generation;
+};
+
+struct parallel_deflate {
+  int threads;
+  struct worker* workers;  // workers[0] is the calling thread
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  unsigned generation;  // counts jobs, a worker runs a job when it sees a new generation
+  int quit;
+
+  // current job, only changed under lock while no blocks are left
+  const unsigned char* input;
+  unsigned long size;
+  unsigned long block_size;
+  int level;
+  unsigned long blocks;
+  unsigned long next_block;
+  unsigned long finished;
+  int error;
+
+  // compressed blocks in slots of slot_size bytes, with their sizes and CRC-32s
+  unsigned char* slots;
+  unsigned long slot_size;
+  unsigned long* sizes;
+  unsigned long* crcs;
+  unsigned long capacity;  // blocks that fit in slots, sizes and crcs
+};
+
+static unsigned long slot_bound(unsigned long block_size) {
+  // compressBound() includes the 6 bytes of the zlib wrapper, which a raw stream uses for the
+  // empty stored block of the sync flush
+  return compressBound(block_size) + 16;
+}
+
+static int compress_block(struct worker* worker, unsigned long block) {
+  parallel_deflate* pool = worker->pool;
+  z_stream* strm = &worker->strm;
+  unsigned long start = block * pool->block_size;
+  unsigned long length = pool->size - start < pool->block_size ? pool->size - start : pool->block_size;
+  int last = block + 1 == pool->blocks;
+  int ret;
+
+  if (worker->level != pool->level) {
+    if (worker->level != -2) {
+      deflateEnd(strm);
+    }
+    memset(strm, 0, sizeof(*strm));
+    worker->level = -2;
+    if (deflateInit2(strm, pool->level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return Z_MEM_ERROR;
+    }
+    worker->level = pool->level;
+  } else if (deflateReset(strm) != Z_OK) {
+    return Z_STREAM_ERROR;
+  }
+  if (start > 0) {
+    unsigned long dictionary = start < DICTIONARY_SIZE ? start : DICTIONARY_SIZE;
+    if (deflateSetDictionary(strm, pool->input + start - dictionary, dictionary) != Z_OK) {
+      return Z_STREAM_ERROR;
+    }
+  }
+  strm->next_in = (Bytef*)pool->input + start;
+  strm->avail_in = length;
+  strm->next_out = pool->slots + block * pool->slot_size;
+  strm->avail_out = pool->slot_size;
+  ret = deflate(strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+  if (last ? ret != Z_STREAM_END : ret != Z_OK || strm->avail_in != 0 || strm->avail_out == 0) {
+    return Z_BUF_ERROR;
+  }
+  pool->sizes[block] = pool->slot_size - strm->avail_out;
+  pool->crcs[block] = crc32(0, pool->input + start, length);
+  return Z_OK;
+}
+
+// Compresses blocks of the current job until none are left.
+static void run_blocks(struct worker* worker) {
+  parallel_deflate* pool = worker->pool;
+  for (;;) {
+    unsigned long block;
+    int ret;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->next_block == pool->blocks) {
+      pthread_mutex_unlock(&pool->lock);
+      return;
+    }
+    block = pool->next_block++;
+    pthread_mutex_unlock(&pool->lock);
+
+    ret = compress_block(worker, block);
+
+    pthread_mutex_lock(&pool->lock);
+    if (ret != Z_OK && pool->error == Z_OK) {
+      pool->error = ret;
+    }
+    if (++pool->finished == pool->blocks) {
+      pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+static void* run_worker(void* data) {
+  struct worker* worker = (struct worker*)data;
+  parallel_deflate* pool = worker->pool;
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (!pool->quit && worker->generation == pool->generation) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->quit) {
+      break;
+    }
+    worker->generation = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    run_blocks(worker);
+    pthread_mutex_lock(&pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+parallel_deflate* parallel_deflate_create(int threads) {
+  parallel_deflate* pool;
+  int i;
+  if (threads < 1) {
+    return NULL;
+  }
+  pool = (parallel_deflate*)calloc(1, sizeof(parallel_deflate));
+  if (pool == NULL) {
+    return NULL;
+  }
+  pool->workers = (struct worker*)calloc(threads, sizeof(struct worker));
+  if (pool->workers == NULL) {
+    free(pool);
+    return NULL;
+  }
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  for (i = 0; i < threads; i++) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].level = -2;
+  }
+  pool->threads = 1;
+  for (i = 1; i < threads; i++) {
+    if (pthread_create(&pool->workers[i].thread, NULL, run_worker, &pool->workers[i]) != 0) {
+      parallel_deflate_destroy(pool);
+      return NULL;
+    }
+    pool->threads++;
+  }
+  return pool;
+}
+
+void parallel_deflate_destroy(parallel_deflate* pool) {
+  int i;
+  pthread_mutex_lock(&pool->lock);
+  pool->quit = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < pool->threads; i++) {
+    if (i > 0) {
+      pthread_join(pool->workers[i].thread, NULL);
+    }
+    if (pool->workers[i].level != -2) {
+      deflateEnd(&pool->workers[i].strm);
+    }
+  }
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->slots);
+  free(pool->sizes);
+  free(pool->crcs);
+  free(pool->workers);
+  free(pool);
+}
+
+unsigned long parallel_deflate_bound(unsigned long size, unsigned long block_size) {
+  unsigned long blocks = size == 0 ? 1 : (size + block_size - 1) / block_size;
+  return 18 + blocks * slot_bound(block_size);
+}
+
+static void put_le32(unsigned char* p, unsigned long value) {
+  p[0] = (unsigned char)value;
+  p[1] = (unsigned char)(value >> 8);
+  p[2] = (unsigned char)(value >> 16);
+  p[3] = (unsigned char)(value >> 24);
+}
+
+int parallel_deflate_gzip(parallel_deflate* pool, unsigned char* output, unsigned long* output_size,
+                          const unsigned char* input, unsigned long size, int level, unsigned long block_size) {
+  static const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+  unsigned long blocks = size == 0 ? 1 : (size + block_size - 1) / block_size;
+  unsigned long slot_size = slot_bound(block_size);
+  unsigned long pos;
+  unsigned long crc;
+  unsigned long block;
+  int error;
+
+  if (block_size == 0 || level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION) {
+    return Z_STREAM_ERROR;
+  }
+  if (blocks > pool->capacity || slot_size != pool->slot_size) {
+    free(pool->slots);
+    free(pool->sizes);
+    free(pool->crcs);
+    pool->slots = (unsigned char*)malloc(blocks * slot_size);
+    pool->sizes = (unsigned long*)malloc(blocks * sizeof(unsigned long));
+    pool->crcs = (unsigned long*)malloc(blocks * sizeof(unsigned long));
+    pool->capacity = 0;
+    if (pool->slots == NULL || pool->sizes == NULL || pool->crcs == NULL) {
+      return Z_MEM_ERROR;
+    }
+    pool->capacity = blocks;
+    pool->slot_size = slot_size;
+  }
+
+  // hand the blocks to the workers and compress along with them
+  pthread_mutex_lock(&pool->lock);
+  pool->input = input;
+  pool->size = size;
+  pool->block_size = block_size;
+  pool->level = level;
+  pool->blocks = blocks;
+  pool->next_block = 0;
+  pool->finished = 0;
+  pool->error = Z_OK;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  run_blocks(&pool->workers[0]);
+  pthread_mutex_lock(&pool->lock);
+  while (pool->finished < pool->blocks) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  error = pool->error;
+  pthread_mutex_unlock(&pool->lock);
+  if (error != Z_OK) {
+    return error;
+  }
+
+  // concatenate the blocks in order
+  if (*output_size < sizeof(header)) {
+    return Z_BUF_ERROR;
+  }
+  memcpy(output, header, sizeof(header));
+  pos = sizeof(header);
+  crc = crc32(0, Z_NULL, 0);
+  for (block = 0; block < blocks; block++) {
+    unsigned long length = size - block * block_size < block_size ? size - block * block_size : block_size;
+    if (*output_size - pos < pool->sizes[block]) {
+      return Z_BUF_ERROR;
+    }
+    memcpy(output + pos, pool->slots + block * slot_size, pool->sizes[block]);
+    pos += pool->sizes[block];
+    crc = crc32_combine(crc, pool->crcs[block], length);
+  }
+  if (*output_size - pos < 8) {
+    return Z_BUF_ERROR;
+  }
+  put_le32(output + pos, crc);
+  put_le32(output + pos + 4, size);
+  *output_size = pos + 8;
+  return Z_OK;
+}
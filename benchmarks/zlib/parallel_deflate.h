@@ -0,0 +1,35 @@
+// pigz-style parallel gzip compression on top of zlib. The input is split into blocks that are
+// deflated independently on a pool of threads. Every block but the first is primed with the last
+// 32 KiB of the block before it by deflateSetDictionary(), and every block but the last ends with
+// a Z_SYNC_FLUSH, so that the blocks concatenate into one deflate stream. The CRC-32 of the gzip
+// trailer is put together from the CRC-32s of the blocks with crc32_combine().
+
+#ifndef PARALLEL_DEFLATE_H
+#define PARALLEL_DEFLATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct parallel_deflate parallel_deflate;
+
+// Creates a pool for threads compressing threads, the calling thread and threads - 1 workers.
+// Returns NULL if the workers cannot be started.
+parallel_deflate* parallel_deflate_create(int threads);
+
+void parallel_deflate_destroy(parallel_deflate* pool);
+
+// Upper bound of the gzip size of size bytes compressed in blocks of block_size bytes.
+unsigned long parallel_deflate_bound(unsigned long size, unsigned long block_size);
+
+// Compresses size bytes of input into a gzip stream at output, with the given zlib level. On
+// entry *output_size is the capacity of output, on return the size of the gzip stream. Returns
+// Z_OK, Z_BUF_ERROR if output is too small, or another zlib error.
+int parallel_deflate_gzip(parallel_deflate* pool, unsigned char* output, unsigned long* output_size,
+                          const unsigned char* input, unsigned long size, int level, unsigned long block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PARALLEL_DEFLATE_H
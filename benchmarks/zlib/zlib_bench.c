@@ -6,6 +6,7 @@
  */
 
 #include "zlib.h"
+#include "cpu_features.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -14,14 +15,172 @@
 
 
 // don't inline, to be friendly to js engine osr
-void __attribute__ ((noinline)) do_compress(unsigned char* uncompressed_buffer, unsigned long uncompressed_size, unsigned char* compressed_buffer, unsigned long* compressed_size) {
-  compress(compressed_buffer, compressed_size, uncompressed_buffer, uncompressed_size);
+void __attribute__ ((noinline)) do_compress(unsigned char* uncompressed_buffer, unsigned long uncompressed_size, unsigned char* compressed_buffer, unsigned long* compressed_size, int level) {
+  compress2(compressed_buffer, compressed_size, uncompressed_buffer, uncompressed_size, level);
 }
 
 void __attribute__ ((noinline)) do_decompress(unsigned char* compressed_buffer, unsigned long compressed_size, unsigned char* uncompressed_buffer, unsigned long* uncompressed_size) {
   uncompress(uncompressed_buffer, uncompressed_size, compressed_buffer, compressed_size);
 }
 
+unsigned long __attribute__ ((noinline)) do_deflate_stream(z_stream* strm, unsigned char* input, unsigned long input_size, unsigned char* output, unsigned long output_capacity) {
+  strm->next_in = input;
+  strm->avail_in = input_size;
+  strm->next_out = output;
+  strm->avail_out = output_capacity;
+  return deflate(strm, Z_FINISH) == Z_STREAM_END ? strm->total_out : 0;
+}
+
+unsigned long __attribute__ ((noinline)) do_inflate_stream(z_stream* strm, unsigned char* input, unsigned long input_size, unsigned char* output, unsigned long output_capacity) {
+  strm->next_in = input;
+  strm->avail_in = input_size;
+  strm->next_out = output;
+  strm->avail_out = output_capacity;
+  return inflate(strm, Z_FINISH) == Z_STREAM_END ? strm->total_out : 0;
+}
+
+// Bump allocator for zalloc/zfree. Blocks are not freed one by one, the whole arena is emptied
+// once the stream that uses it has ended.
+typedef struct {
+  unsigned char* base;
+  unsigned long size;
+  unsigned long used;
+} Arena;
+
+static voidpf arena_alloc(voidpf opaque, uInt items, uInt size) {
+  Arena* arena = (Arena*)opaque;
+  unsigned long bytes = ((unsigned long)items * size + 15) & ~15ul;
+  if (bytes > arena->size - arena->used) {
+    return Z_NULL;
+  }
+  voidpf block = arena->base + arena->used;
+  arena->used += bytes;
+  return block;
+}
+
+static void arena_free(voidpf opaque, voidpf address) {
+}
+
+// How the z_stream of every iteration is set up, see stream_iterations().
+enum { SETUP_MALLOC, SETUP_ARENA, SETUP_RESET };
+static const char* const setup_names[] = {"malloc", "arena", "reset"};
+
+// Deflates or inflates input iters times on a z_stream instead of compress2()/uncompress().
+// SETUP_MALLOC initializes and ends the stream in every iteration with zlib's allocator, like
+// compress2() and uncompress() do, SETUP_ARENA does the same with arena_alloc(), and SETUP_RESET
+// keeps one stream and only calls deflateReset()/inflateReset() between iterations. The set-up
+// of every iteration is recorded as a "setup" interval and deflateEnd()/inflateEnd() as a
+// "teardown" interval. Returns the size of the last output, or 0 on an error.
+unsigned long stream_iterations(const char* work_item, int compress, int setup, int level, int iters, unsigned char* input, unsigned long input_size, unsigned char* output, unsigned long output_capacity) {
+  Arena arena = {NULL, 0, 0};
+  z_stream strm;
+  unsigned long size = 0;
+  int ret = Z_OK;
+  int i;
+  memset(&strm, 0, sizeof(strm));
+  if (setup == SETUP_ARENA) {
+    // deflate needs about 270 KiB at the default memLevel, inflate about 40 KiB
+    arena.size = 1 << 20;
+    arena.base = (unsigned char*)malloc(arena.size);
+    strm.zalloc = arena_alloc;
+    strm.zfree = arena_free;
+    strm.opaque = &arena;
+  }
+  if (setup == SETUP_RESET) {
+    ret = compress ? deflateInit(&strm, level) : inflateInit(&strm);
+  }
+  for (i = 0; i < iters && ret == Z_OK; i++) {
+    wasm_perf_record_progress(work_item, i);
+    wasm_perf_mark_begin("setup", i);
+    if (setup == SETUP_RESET) {
+      ret = compress ? deflateReset(&strm) : inflateReset(&strm);
+    } else {
+      ret = compress ? deflateInit(&strm, level) : inflateInit(&strm);
+    }
+    wasm_perf_mark_end("setup", i);
+    if (ret != Z_OK) {
+      break;
+    }
+    if (compress) {
+      size = do_deflate_stream(&strm, input, input_size, output, output_capacity);
+    } else {
+      size = do_inflate_stream(&strm, input, input_size, output, output_capacity);
+    }
+    ret = size != 0 ? Z_OK : Z_DATA_ERROR;
+    if (setup != SETUP_RESET) {
+      wasm_perf_mark_begin("teardown", i);
+      if (compress) {
+        deflateEnd(&strm);
+      } else {
+        inflateEnd(&strm);
+      }
+      wasm_perf_mark_end("teardown", i);
+      arena.used = 0;
+    }
+  }
+  wasm_perf_record_progress(work_item, iters);
+  if (setup == SETUP_RESET) {
+    if (compress) {
+      deflateEnd(&strm);
+    } else {
+      inflateEnd(&strm);
+    }
+  }
+  free(arena.base);
+  return ret == Z_OK ? size : 0;
+}
+
+// Checksum implementations, selected by restricting the CPU features that zlib may use.
+static const struct {
+  const char* name;
+  unsigned features;
+} checksum_impls[] = {
+  {"scalar", 0},
+  {"ssse3", Z_CPU_SSSE3},
+  {"avx2", Z_CPU_AVX2},
+  {"pclmul", Z_CPU_PCLMULQDQ},
+  {"simd128", Z_CPU_SIMD128},
+  {"auto", ~0u},
+};
+
+// Checksums 16 MiB per iteration in calls of buffer_size bytes, reported as GB per second.
+int checksum(const char* algorithm, const char* impl, unsigned long buffer_size, int iters) {
+  const unsigned long bytes_per_iter = 16 << 20;
+  unsigned features = 0;
+  int found = 0;
+  int i;
+  for (i = 0; i < (int)(sizeof(checksum_impls) / sizeof(checksum_impls[0])); i++) {
+    if (strcmp(impl, checksum_impls[i].name) == 0) {
+      features = checksum_impls[i].features;
+      found = 1;
+    }
+  }
+  int is_crc32 = strcmp(algorithm, "crc32") == 0;
+  if (!found || buffer_size == 0 || (features != ~0u && (zlibCpuFeatures() & features) != features)) {
+    printf("error: %s %s is not available for %lu byte buffers\n", algorithm, impl, buffer_size);
+    return -1;
+  }
+  zlibRestrictCpuFeatures(features);
+
+  unsigned char* buffer = (unsigned char*)malloc(buffer_size);
+  for (i = 0; i < (int)buffer_size; i++) {
+    buffer[i] = (unsigned char)(i * 7 + (i >> 8));
+  }
+  unsigned long calls = (bytes_per_iter + buffer_size - 1) / buffer_size;
+  uLong check = is_crc32 ? crc32(0L, Z_NULL, 0) : adler32(0L, Z_NULL, 0);
+  for (i = 0; i < iters; i++) {
+    wasm_perf_record_progress("GB", (float)((double)i * calls * buffer_size / 1e9));
+    unsigned long call;
+    for (call = 0; call < calls; call++) {
+      check = is_crc32 ? crc32(check, buffer, buffer_size) : adler32(check, buffer, buffer_size);
+    }
+  }
+  wasm_perf_record_progress("GB", (float)((double)iters * calls * buffer_size / 1e9));
+  printf("%s: %08lx, features %x\n", algorithm, (unsigned long)check, zlibCpuFeatures());
+  free(buffer);
+  return 0;
+}
+
 int main(int argc, char **argv) {
   unsigned long uncompressed_size = 100000;
   int iters;
@@ -38,6 +197,50 @@ int main(int argc, char **argv) {
     default: printf("error: %d\\n", arg); return -1;
   }
 
+  // crc32|adler32 <level> <implementation> <buffer size>
+  if (argc > 1 && (strcmp(argv[1], "crc32") == 0 || strcmp(argv[1], "adler32") == 0)) {
+    if (checksum(argv[1], argc > 3 ? argv[3] : "auto", argc > 4 ? strtoul(argv[4], NULL, 10) : 65536, iters / 10 + 1) != 0) {
+      return -1;
+    }
+    printf("ok.\n");
+    return 0;
+  }
+
+  // compress|decompress <level> classic|fast [<zlib level> [oneshot|malloc|arena|reset]]:
+  // classic runs the original zlib code, without the SIMD checksums and without either fast
+  // path. fast adds only the FAST_DEFLATE hash and longest_match() to deflate, or only
+  // inflate_fast_chunk() to inflate. Both compress the input of decompress the same way and
+  // check the result by inflating the compressed data once. oneshot calls
+  // compress2()/uncompress(), the others run on a z_stream, see stream_iterations().
+  int compress_level = Z_DEFAULT_COMPRESSION;
+  int verify = 0;
+  int setup = -1;
+  if (argc > 3 && (enable_compress || enable_decompress)) {
+    unsigned feature = enable_compress ? Z_FAST_DEFLATE : Z_FAST_INFLATE;
+    if (strcmp(argv[3], "classic") == 0) {
+      zlibRestrictCpuFeatures(0);
+    } else if (strcmp(argv[3], "fast") == 0 && (zlibCpuFeatures() & feature)) {
+      zlibRestrictCpuFeatures(feature);
+    } else {
+      printf("error: %s %s is not available\n", argv[1], argv[3]);
+      return -1;
+    }
+    compress_level = argc > 4 ? atoi(argv[4]) : Z_DEFAULT_COMPRESSION;
+    verify = 1;
+    if (argc > 5 && strcmp(argv[5], "oneshot") != 0) {
+      int index;
+      for (index = 0; index < (int)(sizeof(setup_names) / sizeof(setup_names[0])); index++) {
+        if (strcmp(argv[5], setup_names[index]) == 0) {
+          setup = index;
+        }
+      }
+      if (setup < 0) {
+        printf("error: unknown set-up %s\n", argv[5]);
+        return -1;
+      }
+    }
+  }
+
   unsigned long maxCompressedSize = compressBound(uncompressed_size);
   unsigned long compressed_size = maxCompressedSize;
   unsigned char* uncompressed_buffer = (unsigned char*)malloc(uncompressed_size);
@@ -61,18 +264,42 @@ int main(int argc, char **argv) {
     i++;
   }
 
-  if (enable_compress) {
+  if (enable_compress && setup >= 0) {
+    compressed_size = stream_iterations("compress", 1, setup, compress_level, iters, uncompressed_buffer, uncompressed_size, compressed_buffer, maxCompressedSize);
+    if (compressed_size == 0) {
+      printf("error: deflate on a %s stream failed\n", setup_names[setup]);
+      return -1;
+    }
+  } else if (enable_compress) {
     for (i = 0; i < iters; i++) {
       wasm_perf_record_progress("compress", i);
-      do_compress(uncompressed_buffer, uncompressed_size, compressed_buffer, &compressed_size);
+      compressed_size = maxCompressedSize;
+      do_compress(uncompressed_buffer, uncompressed_size, compressed_buffer, &compressed_size, compress_level);
     }
     wasm_perf_record_progress("compress", iters);
   } else if (enable_decompress) {
-    do_compress(uncompressed_buffer, uncompressed_size, compressed_buffer, &compressed_size);
+    do_compress(uncompressed_buffer, uncompressed_size, compressed_buffer, &compressed_size, compress_level);
   }
   printf("sizes: %d,%d\n", (int)uncompressed_size, (int)compressed_size);
 
-  if (enable_decompress) {
+  if (verify) {
+    unsigned long size = uncompressed_size;
+    unsigned char* check_buffer = (unsigned char*)malloc(uncompressed_size);
+    if (uncompress(check_buffer, &size, compressed_buffer, compressed_size) != Z_OK ||
+        size != uncompressed_size || memcmp(check_buffer, uncompressed_buffer, size) != 0) {
+      printf("error: level %d does not decompress to the input\n", compress_level);
+      return -1;
+    }
+    free(check_buffer);
+    printf("ratio: %.4f\n", (double)uncompressed_size / compressed_size);
+  }
+
+  if (enable_decompress && setup >= 0) {
+    if (stream_iterations("decompress", 0, setup, compress_level, iters, compressed_buffer, compressed_size, uncompressed_buffer, uncompressed_size) != uncompressed_size) {
+      printf("error: inflate on a %s stream failed\n", setup_names[setup]);
+      return -1;
+    }
+  } else if (enable_decompress) {
     for (i = 0; i < iters; i++) {
       wasm_perf_record_progress("decompress", i);
       do_decompress(compressed_buffer, compressed_size, uncompressed_buffer, &uncompressed_size);
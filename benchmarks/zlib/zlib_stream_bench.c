@@ -0,0 +1,484 @@
+// Streaming zlib benchmark over generated corpora. zlib_bench compresses one synthetic buffer with
+// compress()/uncompress(); this one feeds deflate() and inflate() a chunk at a time, optionally with
+// a Z_SYNC_FLUSH after every chunk, and writes and reads .gz files with gzwrite()/gzread() in tmpfs,
+// or MEMFS for Wasm. The "MB" progress counts megabytes of uncompressed data.
+//
+//   zlib_stream_bench deflate|inflate|gzwrite|gzread <level> <corpus> <chunk size> [none|sync [window bits]]
+//   zlib_stream_bench parallel <level> <corpus> <block size> <threads>
+//
+// window bits are passed to deflateInit2()/inflateInit2(), so 9 to 15 give a zlib stream, -9 to
+// -15 raw deflate and 25 to 31 gzip. gzopen() has no such setting, so gzwrite and gzread reject
+// them.
+//
+// parallel compresses to gzip in blocks on threads threads with parallel_deflate.h, and reports
+// how much larger the result is than one gzip stream of the whole corpus. More than one thread
+// needs zlib_stream_bench_threads in Wasm.
+//
+// The corpora are text, json (structured log lines), binary (executable-like) and compressed
+// (deflated text). They are generated from fixed seeds, so that every run and every engine works
+// on the same bytes.
+
+#include "zlib.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "wasm_perf.h"
+#include "parallel_deflate.h"
+
+static const unsigned long corpus_size = 4 << 20;
+
+static uint32_t random_state;
+
+static uint32_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Random number below n, skewed towards 0 so that some words and values are a lot more common
+// than others.
+static unsigned skewed_random(unsigned n) {
+  double r = (next_random() & 0xffff) / 65536.0;
+  return (unsigned)(r * r * r * n);
+}
+
+static const char* const syllables[] = {
+  "the", "in", "er", "an", "re", "on", "at", "en", "nd", "ti", "es", "or", "te", "of",
+  "ed", "is", "it", "al", "ar", "st", "to", "nt", "ng", "se", "ha", "as", "ou", "io",
+  "le", "ve", "co", "me", "de", "hi", "ri", "ro", "ic", "ne", "ea", "ra", "ce", "ly",
+};
+#define NUM_SYLLABLES (sizeof(syllables) / sizeof(syllables[0]))
+#define NUM_WORDS 2048
+
+static char words[NUM_WORDS][16];
+
+static void generate_words(void) {
+  int i, j;
+  random_state = 0x9e3779b9;
+  for (i = 0; i < NUM_WORDS; i++) {
+    int count = 1 + (i * 3 / NUM_WORDS) + next_random() % 2;
+    words[i][0] = '\0';
+    for (j = 0; j < count; j++) {
+      strcat(words[i], syllables[next_random() % NUM_SYLLABLES]);
+    }
+  }
+}
+
+// Appends a sentence of common words, capitalized and with the odd comma, and returns its length.
+static int sentence(char* out, int max_words) {
+  int count = 4 + next_random() % max_words;
+  int length = 0;
+  int i;
+  for (i = 0; i < count; i++) {
+    const char* word = words[skewed_random(NUM_WORDS)];
+    length += sprintf(out + length, i == 0 ? "%c%s" : " %c%s",
+                      i == 0 ? word[0] - 'a' + 'A' : word[0], word + 1);
+    if (i + 1 < count && next_random() % 12 == 0) {
+      out[length++] = ',';
+    }
+  }
+  out[length] = '\0';
+  return length;
+}
+
+// Prose: sentences of words with a skewed frequency, in paragraphs.
+static void generate_text(unsigned char* buffer, unsigned long size) {
+  char paragraph[4096];
+  unsigned long pos = 0;
+  while (pos < size) {
+    int sentences = 3 + next_random() % 6;
+    int length = 0;
+    while (sentences-- > 0) {
+      length += sentence(paragraph + length, 16);
+      paragraph[length++] = '.';
+      paragraph[length++] = sentences ? ' ' : '\n';
+    }
+    paragraph[length++] = '\n';
+    if ((unsigned long)length > size - pos) {
+      length = size - pos;
+    }
+    memcpy(buffer + pos, paragraph, length);
+    pos += length;
+  }
+}
+
+// One JSON object per line, like the structured logs of a web service.
+static void generate_json(unsigned char* buffer, unsigned long size) {
+  static const char* const levels[] = {"INFO", "DEBUG", "WARN", "ERROR"};
+  static const char* const services[] = {"checkout", "search", "auth", "inventory", "gateway", "billing"};
+  static const char* const methods[] = {"GET", "POST", "PUT", "DELETE"};
+  static const int statuses[] = {200, 204, 304, 404, 500, 201};
+  char line[1024];
+  char message[512];
+  unsigned long long timestamp = 1700000000000ULL;
+  unsigned long pos = 0;
+  while (pos < size) {
+    timestamp += skewed_random(2000);
+    unsigned ms = (unsigned)(timestamp % 1000);
+    unsigned seconds = (unsigned)(timestamp / 1000 % 86400);
+    sentence(message, 8);
+    int length = sprintf(line,
+        "{\"ts\":\"2023-11-14T%02u:%02u:%02u.%03uZ\",\"level\":\"%s\",\"service\":\"%s\",\"host\":\"web-%02u\","
+        "\"request_id\":\"%08x\",\"method\":\"%s\",\"path\":\"/api/v1/%s/%u\",\"status\":%d,"
+        "\"latency_ms\":%u,\"msg\":\"%s\"}\n",
+        seconds / 3600, seconds / 60 % 60, seconds % 60, ms, levels[skewed_random(4)],
+        services[skewed_random(6)], 1 + skewed_random(32), next_random(), methods[skewed_random(4)],
+        services[skewed_random(6)], skewed_random(100000), statuses[skewed_random(6)],
+        1 + skewed_random(1500), message);
+    if ((unsigned long)length > size - pos) {
+      length = size - pos;
+    }
+    memcpy(buffer + pos, line, length);
+    pos += length;
+  }
+}
+
+// Pages of x86-64-like code, with common opcodes, small displacements and relative calls,
+// mixed with pages of offset tables, identifier strings and zero padding.
+static void generate_binary(unsigned char* buffer, unsigned long size) {
+  static const unsigned char opcodes[] = {
+    0x48, 0x89, 0x8b, 0xe8, 0x83, 0x0f, 0x85, 0x74, 0x75, 0xc3, 0x41, 0xff, 0x31, 0x8d, 0x39, 0xeb,
+  };
+  unsigned long pos = 0;
+  while (pos < size) {
+    unsigned long end = pos + 4096 < size ? pos + 4096 : size;
+    unsigned kind = next_random() % 10;
+    if (kind < 7) {
+      while (pos < end) {
+        unsigned char opcode = opcodes[skewed_random(sizeof(opcodes))];
+        buffer[pos++] = opcode;
+        if (pos < end) {
+          buffer[pos++] = (unsigned char)(0xc0 | skewed_random(64));
+        }
+        if ((opcode == 0xe8 || opcode == 0x8b || opcode == 0x8d) && pos + 4 <= end) {
+          uint32_t displacement = opcode == 0xe8 ? (uint32_t)(next_random() % 0x20000 - 0x10000) : skewed_random(256) * 8;
+          memcpy(buffer + pos, &displacement, 4);
+          pos += 4;
+        }
+      }
+    } else if (kind < 9) {
+      uint32_t offset = next_random() % 0x10000;
+      while (pos + 4 <= end) {
+        offset += 16 + skewed_random(512);
+        memcpy(buffer + pos, &offset, 4);
+        pos += 4;
+      }
+    } else {
+      while (pos < end) {
+        const char* word = words[skewed_random(NUM_WORDS)];
+        unsigned long length = strlen(word) + 1;
+        if (length > end - pos) {
+          length = end - pos;
+        }
+        memcpy(buffer + pos, word, length);
+        pos += length;
+        while (pos < end && (pos & 15) != 0 && next_random() % 4 == 0) {
+          buffer[pos++] = 0;
+        }
+      }
+    }
+    while (pos < end) {
+      buffer[pos++] = 0;
+    }
+  }
+}
+
+// Deflated text, which zlib cannot compress any further.
+static void generate_compressed(unsigned char* buffer, unsigned long size) {
+  const unsigned long text_size = 1 << 20;
+  unsigned char* text = (unsigned char*)malloc(text_size);
+  unsigned char* compressed = (unsigned char*)malloc(compressBound(text_size));
+  unsigned long pos = 0;
+  while (pos < size) {
+    unsigned long length = compressBound(text_size);
+    generate_text(text, text_size);
+    compress2(compressed, &length, text, text_size, 6);
+    if (length > size - pos) {
+      length = size - pos;
+    }
+    memcpy(buffer + pos, compressed, length);
+    pos += length;
+  }
+  free(text);
+  free(compressed);
+}
+
+static const struct {
+  const char* name;
+  void (*generate)(unsigned char* buffer, unsigned long size);
+  uint32_t seed;
+} corpora[] = {
+  {"text", generate_text, 1},
+  {"json", generate_json, 2},
+  {"binary", generate_binary, 3},
+  {"compressed", generate_compressed, 4},
+};
+
+// Deflates size bytes of input, passing deflate() chunk bytes of input and output at a time and
+// flushing after every chunk. Returns the compressed size, or 0 on an error.
+unsigned long __attribute__ ((noinline)) stream_deflate(const unsigned char* input, unsigned long size, unsigned char* output, unsigned long capacity, unsigned long chunk, int flush, int window_bits) {
+  z_stream strm;
+  unsigned long pos = 0;
+  int ret = Z_OK;
+  int last;
+  memset(&strm, 0, sizeof(strm));
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return 0;
+  }
+  strm.next_out = output;
+  do {
+    unsigned long length = size - pos < chunk ? size - pos : chunk;
+    last = pos + length == size;
+    strm.next_in = (Bytef*)input + pos;
+    strm.avail_in = length;
+    pos += length;
+    do {
+      unsigned long room = capacity - strm.total_out;
+      if (room == 0) {
+        ret = Z_BUF_ERROR;
+        break;
+      }
+      strm.avail_out = room < chunk ? room : chunk;
+      ret = deflate(&strm, last ? Z_FINISH : flush);
+      if (ret == Z_BUF_ERROR) {
+        ret = Z_OK;  // the last call left exactly a full output buffer and nothing else
+      }
+    } while (strm.avail_out == 0 && ret == Z_OK);
+  } while (!last && ret == Z_OK);
+  deflateEnd(&strm);
+  return ret == Z_STREAM_END ? strm.total_out : 0;
+}
+
+// Inflates size bytes of input, passing inflate() chunk bytes of input and output at a time.
+// Returns the uncompressed size, or 0 on an error.
+unsigned long __attribute__ ((noinline)) stream_inflate(const unsigned char* input, unsigned long size, unsigned char* output, unsigned long capacity, unsigned long chunk, int window_bits) {
+  z_stream strm;
+  int ret;
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, window_bits) != Z_OK) {
+    return 0;
+  }
+  strm.next_in = (Bytef*)input;
+  strm.next_out = output;
+  do {
+    if (strm.avail_in == 0) {
+      unsigned long left = size - (unsigned long)(strm.next_in - input);
+      strm.avail_in = left < chunk ? left : chunk;
+    }
+    unsigned long room = capacity - strm.total_out;
+    strm.avail_out = room < chunk ? room : chunk;
+    ret = inflate(&strm, Z_NO_FLUSH);
+  } while (ret == Z_OK);
+  inflateEnd(&strm);
+  return ret == Z_STREAM_END ? strm.total_out : 0;
+}
+
+// Writes input to a .gz file in gzwrite() calls of chunk bytes, with a buffer of the same size.
+int __attribute__ ((noinline)) gz_write(const char* path, const unsigned char* input, unsigned long size, unsigned long chunk, int flush) {
+  gzFile file = gzopen(path, "wb");
+  unsigned long pos;
+  if (file == NULL) {
+    return -1;
+  }
+  gzbuffer(file, chunk);
+  for (pos = 0; pos < size; pos += chunk) {
+    unsigned length = size - pos < chunk ? size - pos : chunk;
+    if (gzwrite(file, input + pos, length) != (int)length ||
+        (flush != Z_NO_FLUSH && gzflush(file, flush) != Z_OK)) {
+      gzclose(file);
+      return -1;
+    }
+  }
+  return gzclose(file) == Z_OK ? 0 : -1;
+}
+
+// Reads a .gz file in gzread() calls of chunk bytes. Returns the uncompressed size, or 0 on an
+// error.
+unsigned long __attribute__ ((noinline)) gz_read(const char* path, unsigned char* output, unsigned long capacity, unsigned long chunk) {
+  gzFile file = gzopen(path, "rb");
+  unsigned long total = 0;
+  int length;
+  if (file == NULL) {
+    return 0;
+  }
+  gzbuffer(file, chunk);
+  do {
+    unsigned long room = capacity - total;
+    length = gzread(file, output + total, room < chunk ? room : chunk);
+    total += length > 0 ? length : 0;
+  } while (length > 0 && total < capacity);
+  gzclose(file);
+  return length < 0 ? 0 : total;
+}
+
+// Output capacity for deflating size bytes in chunks of chunk bytes, with the bound of a stream
+// with the same window bits and memLevel as stream_deflate(). Returns 0 for invalid window bits.
+static unsigned long deflate_capacity(unsigned long size, unsigned long chunk, int window_bits) {
+  z_stream strm;
+  unsigned long bound;
+  memset(&strm, 0, sizeof(strm));
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return 0;
+  }
+  bound = deflateBound(&strm, size);
+  deflateEnd(&strm);
+  // sync flushes end a block per chunk, so leave room for the trees of every block
+  return bound + (size / chunk + 1) * 512;
+}
+
+static unsigned long file_size(const char* path) {
+  FILE* file = fopen(path, "rb");
+  long size;
+  if (file == NULL) {
+    return 0;
+  }
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fclose(file);
+  return size < 0 ? 0 : (unsigned long)size;
+}
+
+int main(int argc, char **argv) {
+  int iters;
+  int i;
+  if (argc < 5) {
+    printf("usage: %s deflate|inflate|gzwrite|gzread <level> <corpus> <chunk size> [none|sync [window bits]]\n", argv[0]);
+    printf("       %s parallel <level> <corpus> <block size> <threads>\n", argv[0]);
+    return -1;
+  }
+  const char* mode = argv[1];
+  int arg = argv[2][0] - '0';
+  switch(arg) {
+    case 0: return 0; break;
+    case 1: iters = 1; break;
+    case 2: iters = 3; break;
+    case 3: iters = 10; break;
+    case 4: iters = 30; break;
+    case 5: iters = 100; break;
+    default: printf("error: %d\n", arg); return -1;
+  }
+  int corpus = -1;
+  for (i = 0; i < (int)(sizeof(corpora) / sizeof(corpora[0])); i++) {
+    if (strcmp(argv[3], corpora[i].name) == 0) {
+      corpus = i;
+    }
+  }
+  int is_deflate = strcmp(mode, "deflate") == 0;
+  int is_inflate = strcmp(mode, "inflate") == 0;
+  int is_gzwrite = strcmp(mode, "gzwrite") == 0;
+  int is_gzread = strcmp(mode, "gzread") == 0;
+  int is_parallel = strcmp(mode, "parallel") == 0;
+  if (!is_deflate && !is_inflate && !is_gzwrite && !is_gzread && !is_parallel) {
+    printf("error: unknown mode %s\n", mode);
+    return -1;
+  }
+  unsigned long chunk = strtoul(argv[4], NULL, 10);
+  int flush = !is_parallel && argc > 5 && strcmp(argv[5], "sync") == 0 ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+  int window_bits = !is_parallel && argc > 6 ? atoi(argv[6]) : MAX_WBITS;
+  int threads = is_parallel && argc > 5 ? atoi(argv[5]) : 1;
+  if (corpus < 0 || chunk < 2 || chunk > corpus_size || threads < 1 ||
+      (!is_parallel && argc > 5 && flush == Z_NO_FLUSH && strcmp(argv[5], "none") != 0)) {
+    printf("error: unknown corpus, chunk size, flush mode or thread count\n");
+    return -1;
+  }
+  if ((is_gzwrite || is_gzread) && argc > 6) {
+    printf("error: %s does not take window bits\n", mode);
+    return -1;
+  }
+
+  generate_words();
+  random_state = corpora[corpus].seed;
+  unsigned char* input = (unsigned char*)malloc(corpus_size);
+  corpora[corpus].generate(input, corpus_size);
+
+  unsigned long capacity = deflate_capacity(corpus_size, chunk, window_bits);
+  if (capacity == 0) {
+    printf("error: invalid window bits %d\n", window_bits);
+    return -1;
+  }
+  parallel_deflate* pool = NULL;
+  if (is_parallel) {
+    capacity = parallel_deflate_bound(corpus_size, chunk);
+    pool = parallel_deflate_create(threads);
+    if (pool == NULL) {
+      printf("error: cannot start %d threads\n", threads);
+      return -1;
+    }
+  }
+  unsigned char* compressed = (unsigned char*)malloc(capacity);
+  unsigned char* output = (unsigned char*)malloc(corpus_size);
+  unsigned long compressed_size = 0;
+  unsigned long size = 0;
+  char path[256];
+#ifdef __EMSCRIPTEN__
+  const char* directory = "/tmp";
+#else
+  const char* directory = access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp";
+#endif
+  snprintf(path, sizeof(path), "%s/zlib_stream_bench.%d.gz", directory, (int)getpid());
+
+  if (is_inflate) {
+    compressed_size = stream_deflate(input, corpus_size, compressed, capacity, chunk, flush, window_bits);
+  } else if (is_gzread && gz_write(path, input, corpus_size, chunk, flush) != 0) {
+    printf("error: cannot write %s\n", path);
+    return -1;
+  }
+
+  for (i = 0; i < iters; i++) {
+    wasm_perf_record_progress("MB", (float)((double)i * corpus_size / 1e6));
+    if (is_deflate) {
+      compressed_size = stream_deflate(input, corpus_size, compressed, capacity, chunk, flush, window_bits);
+      size = compressed_size ? corpus_size : 0;
+    } else if (is_inflate) {
+      size = stream_inflate(compressed, compressed_size, output, corpus_size, chunk, window_bits);
+    } else if (is_gzwrite) {
+      size = gz_write(path, input, corpus_size, chunk, flush) == 0 ? corpus_size : 0;
+    } else if (is_parallel) {
+      compressed_size = capacity;
+      size = parallel_deflate_gzip(pool, compressed, &compressed_size, input, corpus_size, Z_DEFAULT_COMPRESSION, chunk) == Z_OK ? corpus_size : 0;
+    } else {
+      size = gz_read(path, output, corpus_size, chunk);
+    }
+    if (size != corpus_size) {
+      printf("error: %s failed\n", mode);
+      unlink(path);
+      return -1;
+    }
+  }
+  wasm_perf_record_progress("MB", (float)((double)iters * corpus_size / 1e6));
+
+  // check the last result
+  if (is_deflate) {
+    size = stream_inflate(compressed, compressed_size, output, corpus_size, corpus_size, window_bits);
+  } else if (is_parallel) {
+    size = stream_inflate(compressed, compressed_size, output, corpus_size, corpus_size, 16 + MAX_WBITS);
+  } else if (is_gzwrite) {
+    size = gz_read(path, output, corpus_size, corpus_size);
+  }
+  if (is_gzwrite || is_gzread) {
+    compressed_size = file_size(path);
+    unlink(path);
+  }
+  if (size != corpus_size || memcmp(input, output, corpus_size) != 0) {
+    printf("error: %s does not round trip\n", mode);
+    return -1;
+  }
+  printf("sizes: %lu,%lu\n", corpus_size, compressed_size);
+  printf("ratio: %.4f\n", (double)corpus_size / compressed_size);
+  if (is_parallel) {
+    // the dictionaries keep most of the matches across blocks, the rest is the cost of splitting
+    unsigned long single_size = stream_deflate(input, corpus_size, compressed, capacity, corpus_size, Z_NO_FLUSH, 16 + MAX_WBITS);
+    printf("single stream: %lu\n", single_size);
+    printf("ratio loss: %.3f%%\n", 100.0 * ((double)compressed_size / single_size - 1));
+    parallel_deflate_destroy(pool);
+  }
+  printf("ok.\n");
+
+  free(input);
+  free(compressed);
+  free(output);
+  return 0;
+}
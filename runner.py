@@ -19,17 +19,32 @@ base_dir = os.path.dirname(os.path.abspath(__file__))
 
 allowed_steps = {'build', 'run', 'analyze'}
 native_envs = {'native'}
-wasm_envs = {'d8', 'chrome', 'mozjs', 'firefox'}
+wasm_envs = {'d8', 'node', 'chrome', 'mozjs', 'firefox'}
 if platform() == 'Darwin':
 	wasm_envs.add('safari')
 allowed_envs = native_envs | wasm_envs
-allowed_benchmarks = {'base64', 'zlib', 'box2d', 'lzma', 'micro', 'sqlite'}
+engine_envs = {'d8', 'node', 'mozjs'}
+allowed_benchmarks = {'base64', 'zlib', 'box2d', 'lzma', 'micro', 'sqlite', 'pthreads', 'startup', 'lua', 'bullet'}
 whitespace = re.compile('\s')
 
+def base_env (env):
+	# Flag set variants are named <env>+<flag set>, e.g. d8+liftoff.
+	return env.split('+', 1)[0]
+
+def copy_counts (copies):
+	# Powers of two up to the maximum number of simultaneous copies, plus the maximum itself.
+	counts = [1]
+	while counts[-1] * 2 < copies:
+		counts.append(counts[-1] * 2)
+	if copies > 1:
+		counts.append(copies)
+	return counts
+
 class Analysis:
 	class Event:
 		def __init__ (self, line):
-			fields = re.split(whitespace, line, 2)
+			# Ids may contain spaces, fields are separated by tabs.
+			fields = line.split('\t', 1)
 			self.time = int(fields[0])
 			self.event_id = fields[1]
 
@@ -37,14 +52,18 @@ class Analysis:
 
 	class Interval:
 		def __init__ (self, line):
-			fields = re.split(whitespace, line, 4)
+			fields = line.split('\t', 2)
 			self.begin_time = int(fields[0])
 			self.end_time = int(fields[1])
-			self.interval_id = fields[2]
-			self.numeric_id = int(fields[3])
+			self.interval_id, numeric_id = fields[2].rsplit('\t', 1)
+			self.numeric_id = int(numeric_id)
 
 		regex = re.compile('\\[INTERVALS\\]\n')
 
+		@property
+		def duration (self):
+			return self.end_time - self.begin_time
+
 	class Progress:
 		def __init__ (self, line):
 			fields = re.split(whitespace, line, 2)
@@ -126,6 +145,22 @@ class Analysis:
 					progress[index].performance = (progress[index].work - progress[index - 1].work) / (progress[index].time - progress[index - 1].time)
 					
 
+	def mean_interval_duration (self, interval_id):
+		durations = [interval.duration for interval in self.intervals if interval.interval_id == interval_id]
+		return sum(durations) / len(durations) if len(durations) > 0 else 0.0
+
+	def interval_performance (self, interval_id, progress_id):
+		# Work done on progress_id per time spent in interval_id, for work that only advances inside those intervals.
+		duration = sum(interval.duration for interval in self.intervals if interval.interval_id == interval_id)
+		return self.progress[progress_id][-1].work / duration if duration > 0 and progress_id in self.progress else 0.0
+
+	def mean_stage_time (self, stage_id, progress_id):
+		# Stage work items accumulate milliseconds, normalize them by the work done on progress_id.
+		if stage_id not in self.progress or progress_id not in self.progress:
+			return 0.0
+		work = self.progress[progress_id][-1].work
+		return self.progress[stage_id][-1].work / work if work > 0 else 0.0
+
 	def plot (self, axes, progress_id, scale, label, **kwargs):
 		summary = self.summaries[progress_id]
 		axes.plot([0, float(summary.start_up_time)/1000, float(summary.start_up_time + summary.warm_up_time)/1000, float(summary.duration)/1000], [0, 0, summary.peak_performance/scale, summary.peak_performance/scale], linestyle = 'dashed', **kwargs)
@@ -140,9 +175,35 @@ class Benchmark:
 			self.wasm_binary = os.path.join(base_dir, 'out', benchmark_name, 'wasm', config.get('binary', '{}_bench'.format(benchmark_name)))
 			self.arguments = config.get('arguments', [])
 			self.runs = config.get('runs', 1)
-
-	def __init__ (self, name, envs, d8, node, mozjs):
+			# How wasm_perf calls reach the recorder in JS engines: glue or buffered (see wrapper.js).
+			self.bridge = config.get('bridge', 'glue')
+			self.envs = config.get('envs', None)
+			self.intervals = config.get('intervals', [])
+			# Work items that count milliseconds spent per stage of a unit of the quantity.
+			self.stages = config.get('stages', [])
+			# Work items that count events per unit of the quantity, charted as their mean per unit.
+			self.counters = config.get('counters', [])
+			# Profiles of the same series are plotted as a scaling curve over their series values.
+			self.series = config.get('series', None)
+			self.series_value = config.get('series_value', 0)
+			# Axis label of the series values, defaults to the benchmark's series_label.
+			self.series_label = config.get('series_label', None)
+			# Name of a profile with the same quantity that this one is charted as a speedup against.
+			self.baseline = config.get('baseline', None)
+			# Interval that the quantity only advances in. Speedups and series then use the work per time spent
+			# in this interval instead of the peak performance, which the time between the intervals dilutes.
+			self.rate_interval = config.get('rate_interval', None)
+
+		def performance (self, analysis, summary):
+			return analysis.interval_performance(self.rate_interval, self.quantity) if self.rate_interval is not None else summary.peak_performance
+
+		def enabled (self, env):
+			# Profiles may be restricted to engines or to individual flag set variants.
+			return self.envs is None or env in self.envs or base_env(env) in self.envs
+
+	def __init__ (self, name, envs, d8, node, mozjs, copies = 1):
 		self.name = name
+		self.copies = copies
 		self.d8 = d8
 		self.node = node
 		self.mozjs = mozjs
@@ -155,13 +216,60 @@ class Benchmark:
 		else:
 			self.configure = ['cmake', os.path.join(os.pardir, os.pardir, os.pardir, 'benchmarks', self.name)]
 			self.make = ['make']
+			build_config = {}
+		self.series_label = config.get('series_label', 'Size')
+		if 'threads' in build_config and self.configure[0] == 'cmake':
+			self.configure += ['-DENABLE_PTHREADS=ON', '-DPTHREAD_POOL_SIZE={}'.format(build_config['threads'])]
 		if 'profiles' in config:
 			self.profiles = [Benchmark.ExecutionProfile(self.name, profile_name, profile_config) for profile_name, profile_config in config['profiles'].items()]
 		else:
 			self.profiles = [Benchmark.ExecutionProfile(self.name, 'runs', {})]
 		self.verbose = False
 		self.run_profiler = False
-		self.envs = set(envs)
+		self.envs = set(env for env in envs if base_env(env) in config.get('envs', allowed_envs))
+		# Every named engine flag set becomes its own env next to the engine's default configuration.
+		self.engine_flags = {}
+		for engine, flag_sets in config.get('engine_flags', {}).items():
+			if engine not in engine_envs:
+				raise ValueError('Engine flags given for unsupported engine {engine}'.format(engine = engine))
+			if engine in self.envs:
+				for flag_set, flags in flag_sets.items():
+					env = '{engine}+{flag_set}'.format(engine = engine, flag_set = flag_set)
+					self.engine_flags[env] = flags
+					self.envs.add(env)
+
+	def engine_variants (self, engine):
+		return sorted((env, self.engine_flags.get(env, [])) for env in self.envs if base_env(env) == engine)
+
+	def engine_command (self, env, flags, profile, bridge):
+		engine = base_env(env)
+		if engine == 'node':
+			return [self.node] + flags + [
+				'--experimental-modules',
+				'--experimental-wasm-modules',
+				os.path.join(base_dir, 'wrapper.js'),
+				os.path.join(base_dir, 'out', 'tools', 'wasm', 'recorder'),
+				profile.wasm_binary,
+				str(profile.runs),
+				'true' if self.verbose else 'false',
+				bridge,
+			] + profile.arguments
+		options = '''const recorder_js = "{recorder}.mjs";
+			 const wasm_js = "{module}.mjs";
+			 const argv = {arguments};
+			 const runs = {runs};
+			 const verbose = {verbose};
+			 const bridge = "{bridge}";'''.format(
+				recorder = os.path.join(base_dir, 'out', 'tools', 'wasm', 'recorder'),
+				module = profile.wasm_binary,
+				arguments = json.dumps(profile.arguments),
+				runs = profile.runs,
+				verbose = 'true' if self.verbose else 'false',
+				bridge = bridge)
+		if engine == 'd8':
+			return [self.d8] + flags + ['-e', options, os.path.join(base_dir, 'wrapper.js')]
+		else:
+			return [self.mozjs] + flags + ['-e', options, '-f', os.path.join(base_dir, 'wrapper.js')]
 
 	def set_verbose (self, enabled):
 		self.verbose = enabled
@@ -193,9 +301,9 @@ class Benchmark:
 				return proc.returncode
 
 	@staticmethod
-	def build_tools (envs, verbose = False):
-		# Native build
-		if not native_envs.isdisjoint(envs):
+	def build_tools (envs, verbose = False, copies = 1):
+		# Native build, the recorder also drives simultaneous copies in JS engines
+		if not native_envs.isdisjoint(envs) or (copies > 1 and not engine_envs.isdisjoint(envs)):
 			build_dir = os.path.join(base_dir, 'out', 'tools', 'native')
 			os.makedirs(build_dir, exist_ok = True)
 			print('Building helper tools with Clang')
@@ -231,22 +339,24 @@ class Benchmark:
 					self.envs -= native_envs
 
 		# Wasm build
-		if not wasm_envs.isdisjoint(self.envs):
+		if any(base_env(env) in wasm_envs for env in self.envs):
 			build_dir = os.path.join(base_dir, 'out', self.name, 'wasm')
 			os.makedirs(build_dir, exist_ok = True)
 			print('Building {benchmark} with Emscripten'.format(benchmark = self.name))
 			return_code = self.call(['emcmake' if self.configure[0] == 'cmake' else 'emconfigure'] + self.configure, cwd = build_dir, stdout = None if self.verbose else subprocess.DEVNULL, stderr = None if self.verbose else subprocess.DEVNULL)
 			if return_code != 0:
-				self.envs -= wasm_envs
+				self.envs = {env for env in self.envs if base_env(env) not in wasm_envs}
 			else:
 				return_code = self.call(['emmake'] + self.make, cwd = build_dir, stdout = None if self.verbose else subprocess.DEVNULL, stderr = None if self.verbose else subprocess.DEVNULL)
 				if return_code != 0:
-					self.envs -= wasm_envs
+					self.envs = {env for env in self.envs if base_env(env) not in wasm_envs}
 	
 	def run (self):
 		# Native execution
 		if 'native' in self.envs:
 			for profile in self.profiles:
+				if not profile.enabled('native'):
+					continue
 				print('Benchmarking {benchmark} {profile} natively'.format(benchmark = self.name, profile = profile.name))
 				args = [os.path.join(base_dir, 'out', 'tools', 'native', 'recorder'),
 					'-r', str(profile.runs),
@@ -273,65 +383,58 @@ class Benchmark:
 					self.envs.remove('native')
 
 		# d8 execution
-		if 'd8' in self.envs:
+		for env, flags in self.engine_variants('d8'):
 			for profile in self.profiles:
-				print('Benchmarking {benchmark} {profile} in d8'.format(benchmark = self.name, profile = profile.name))
-				with open(os.path.join(base_dir, 'out', self.name, '{}_d8.txt'.format(profile.name)), 'w') as output_file:
-					cmd = [
-						self.d8,
-						'-e', '''const recorder_js = "{recorder}.mjs";
-							 const wasm_js = "{module}.mjs";
-							 const argv = {arguments};
-							 const runs = {runs};
-							 const verbose = {verbose};'''.format(
-								recorder = os.path.join(base_dir, 'out', 'tools', 'wasm', 'recorder'),
-								module = profile.wasm_binary,
-								arguments = json.dumps(profile.arguments),
-								runs = profile.runs,
-								verbose = 'true' if self.verbose else 'false'),
-						os.path.join(base_dir, 'wrapper.js')
-					]
+				if not profile.enabled(env):
+					continue
+				print('Benchmarking {benchmark} {profile} in {env}'.format(benchmark = self.name, profile = profile.name, env = env))
+				with open(os.path.join(base_dir, 'out', self.name, '{profile}_{env}.txt'.format(profile = profile.name, env = env)), 'w') as output_file:
+					cmd = self.engine_command(env, flags, profile, profile.bridge)
 					if self.run_profiler:
+						cmd[1:1] = [
+							'--perf-prof',
+							'--no-wasm-async-compilation'
+						]
 						cmd[0:0] = [
 							'perf',
 							'record',
 							'-k', 'mono',
-							'-o', os.path.join(base_dir, 'out', self.name, '{}_d8.raw.perf'.format(profile.name)),
+							'-o', os.path.join(base_dir, 'out', self.name, '{profile}_{env}.raw.perf'.format(profile = profile.name, env = env)),
 							'--'
 						]
-						cmd[8:8] = [
-							'--perf-prof',
-							'--no-wasm-async-compilation'
-						]
 					return_code = self.call(cmd, cwd = os.path.dirname(profile.wasm_binary), stdout = output_file)
 				if return_code != 0:
 					sys.stderr.write('Execution failed with status {status}\n'.format(status = return_code))
 					sys.stderr.flush()
-					self.envs.remove('d8')
+					self.envs.remove(env)
+					break
 				if self.run_profiler:
 					self.call([
 						'perf',
 						'inject',
 						'-j',
-						'-i', os.path.join(base_dir, 'out', self.name, '{}_d8.raw.perf'.format(profile.name)),
-						'-o', os.path.join(base_dir, 'out', self.name, '{}_d8.perf'.format(profile.name))
+						'-i', os.path.join(base_dir, 'out', self.name, '{profile}_{env}.raw.perf'.format(profile = profile.name, env = env)),
+						'-o', os.path.join(base_dir, 'out', self.name, '{profile}_{env}.perf'.format(profile = profile.name, env = env))
 					], cwd = os.path.dirname(profile.wasm_binary))
 
 		# Chrome & Firefox execution
 		for browser in 'chrome', 'firefox', 'safari':
 			if browser in self.envs:
 				for profile in self.profiles:
+					if not profile.enabled(browser):
+						continue
 					print('Benchmarking {benchmark} {profile} in {browser}'.format(benchmark = self.name, profile = profile.name, browser = browser.capitalize()))
 					return_code = self.call([
 						'node',
 						'browser_support/run.js',
 						browser,
-						'wrapper.html?recorder=/{recorder}.mjs&wasm=/{module}.mjs&{arguments}&runs={runs}&verbose={verbose}'.format(
+						'wrapper.html?recorder=/{recorder}.mjs&wasm=/{module}.mjs&{arguments}&runs={runs}&verbose={verbose}&bridge={bridge}'.format(
 							recorder = urlquote(os.path.join('out', 'tools', 'wasm', 'recorder')),
 							module = urlquote(os.path.relpath(profile.wasm_binary, base_dir)),
 							arguments = '&'.join(['arg=' + urlquote(arg) for arg in profile.arguments]),
 							runs = profile.runs,
-							verbose = 'true' if self.verbose else 'false'),
+							verbose = 'true' if self.verbose else 'false',
+							bridge = profile.bridge),
 						os.path.join(base_dir, 'out', self.name, '{profile}_{browser}.txt'.format(profile = profile.name, browser = browser))
 					])
 					if return_code != 0:
@@ -340,48 +443,55 @@ class Benchmark:
 						self.envs.remove(browser)
 
 		# Node execution
-		if 'node' in self.envs:
+		for env, flags in self.engine_variants('node'):
 			for profile in self.profiles:
-				print('Benchmarking {benchmark} {profile} in Node.js'.format(benchmark = self.name, profile = profile.name))
-				with open(os.path.join(base_dir, 'out', self.name, '{}_node.txt'.format(profile.name)), 'w') as output_file:
-					return_code = self.call([
-						self.node,
-						'--experimental-modules',
-						'--experimental-wasm-modules',
-						os.path.join(base_dir, 'wrapper.js'),
-						os.path.join(base_dir, 'out', 'tools', 'wasm', 'recorder'),
-						profile.wasm_binary,
-						str(profile.runs),
-						'true' if self.verbose else 'false',
-					] + profile.arguments, cwd = os.path.dirname(profile.wasm_binary), stdout = output_file)
+				if not profile.enabled(env):
+					continue
+				print('Benchmarking {benchmark} {profile} in Node.js ({env})'.format(benchmark = self.name, profile = profile.name, env = env))
+				with open(os.path.join(base_dir, 'out', self.name, '{profile}_{env}.txt'.format(profile = profile.name, env = env)), 'w') as output_file:
+					return_code = self.call(self.engine_command(env, flags, profile, profile.bridge), cwd = os.path.dirname(profile.wasm_binary), stdout = output_file)
 				if return_code != 0:
 					sys.stderr.write('Execution failed with status {status}\n'.format(status = return_code))
 					sys.stderr.flush()
-					self.envs.remove('node')
+					self.envs.remove(env)
+					break
 
 		# mozjs execution
-		if 'mozjs' in self.envs:
+		for env, flags in self.engine_variants('mozjs'):
 			for profile in self.profiles:
-				print('Benchmarking {benchmark} {profile} in SpiderMonkey'.format(benchmark = self.name, profile = profile.name))
-				with open(os.path.join(base_dir, 'out', self.name, '{}_mozjs.txt'.format(profile.name)), 'w') as output_file:
-					return_code = self.call([
-						self.mozjs,
-						'-e', '''const recorder_js = "{recorder}.mjs";
-							 const wasm_js = "{module}.mjs";
-							 const argv = {arguments};
-							 const runs = {runs};
-							 const verbose = {verbose};'''.format(
-								recorder = os.path.join(base_dir, 'out', 'tools', 'wasm', 'recorder'),
-								module = profile.wasm_binary,
-								arguments = json.dumps(profile.arguments),
-								runs = profile.runs,
-								verbose = 'true' if self.verbose else 'false'),
-						'-f', os.path.join(base_dir, 'wrapper.js')
-					], cwd = os.path.dirname(profile.wasm_binary), stdout = output_file)
+				if not profile.enabled(env):
+					continue
+				print('Benchmarking {benchmark} {profile} in SpiderMonkey ({env})'.format(benchmark = self.name, profile = profile.name, env = env))
+				with open(os.path.join(base_dir, 'out', self.name, '{profile}_{env}.txt'.format(profile = profile.name, env = env)), 'w') as output_file:
+					return_code = self.call(self.engine_command(env, flags, profile, profile.bridge), cwd = os.path.dirname(profile.wasm_binary), stdout = output_file)
 				if return_code != 0:
 					sys.stderr.write('Execution failed with status {status}\n'.format(status = return_code))
 					sys.stderr.flush()
-					self.envs.remove('mozjs')
+					self.envs.remove(env)
+					break
+
+		# Simultaneous copies, all started together by the native recorder which adds up their progress.
+		# JS engines print their records through the pipe_out bridge for that (see wrapper.js).
+		copies_envs = sorted(env for env in self.envs if env == 'native' or base_env(env) in engine_envs)
+		for copies in copy_counts(self.copies)[1:]:
+			for env in copies_envs:
+				for profile in self.profiles:
+					if not profile.enabled(env):
+						continue
+					print('Benchmarking {benchmark} {profile} in {env} with {copies} copies'.format(benchmark = self.name, profile = profile.name, env = env, copies = copies))
+					args = [os.path.join(base_dir, 'out', 'tools', 'native', 'recorder'),
+						'-c', str(copies),
+						'-o', os.path.join(base_dir, 'out', self.name, '{profile}_{env}_x{copies}.txt'.format(profile = profile.name, env = env, copies = copies))]
+					if env == 'native':
+						args += ['-r', str(profile.runs), '-R', '--', profile.native_binary] + profile.arguments
+					else:
+						args += ['--'] + self.engine_command(env, self.engine_flags.get(env, []), profile, 'pipe_out')
+					if self.verbose:
+						args.insert(1, '-v')
+					return_code = self.call(args, cwd = None if env == 'native' else os.path.dirname(profile.wasm_binary))
+					if return_code != 0:
+						sys.stderr.write('Execution failed with status {status}\n'.format(status = return_code))
+						sys.stderr.flush()
 
 	def analyze (self, format):
 		performances_figure = plt.figure()
@@ -401,15 +511,28 @@ class Benchmark:
 		summary_colors = []
 		summary_ticks = []
 		summary_labels = []
-		summary_legend_labels = {env: color for env, color in {
-				'native': 'gray',
-				'd8': 'darkolivegreen',
-				'chrome': 'darkgreen',
-				'node': 'darkorange',
-				'mozjs': 'coral',
-				'firefox': 'crimson',
-				'safari': 'cornflowerblue'
-			}.items() if env in self.envs}
+		env_colors = {
+			'native': 'gray',
+			'd8': 'darkolivegreen',
+			'chrome': 'darkgreen',
+			'node': 'darkorange',
+			'mozjs': 'coral',
+			'firefox': 'crimson',
+			'safari': 'cornflowerblue'
+		}
+		summary_legend_labels = {env: color for env, color in env_colors.items() if env in self.envs}
+		# Time per unit of the quantity by series, env and series value
+		series_times = {}
+		series_quantities = {}
+		series_labels = {}
+		# Peak performance by profile and env, for the speedups over baseline profiles
+		peak_performances = {}
+		# Flag set variants get increasingly lighter shades of their engine's color.
+		for engine in engine_envs:
+			variants = [env for env, flags in self.engine_variants(engine) if env != engine]
+			for index, env in enumerate(variants):
+				shade = 0.7 * (index + 1) / (len(variants) + 1)
+				summary_legend_labels[env] = tuple(channel + (1.0 - channel) * shade for channel in matplotlib.colors.to_rgb(env_colors[engine]))
 		position = 0
 		with open(os.path.join(base_dir, 'out', self.name, 'overview.html'), 'w') as overview:
 			overview.write('<html>\n<head>\n\t<title>{benchmark} benchmark</title>\n</head><body>\n'.format(benchmark = self.name))
@@ -423,12 +546,18 @@ class Benchmark:
 				scale = 1
 				summary_ticks.append(position)
 				summary_labels.append(profile.name)
+				interval_durations = {}
+				stage_times = {}
+				counter_values = {}
+				if profile.series is not None:
+					series_quantities[profile.series] = profile.quantity
+					series_labels[profile.series] = profile.series_label or self.series_label
 
 				# Native execution
-				if 'native' in self.envs:
+				if 'native' in self.envs and profile.enabled('native'):
 					with open(os.path.join(base_dir, 'out', self.name, '{}_native.txt'.format(profile.name)), 'r') as file:
 						analysis = Analysis(file)
-					summary = analysis.summaries[profile.name]
+					summary = analysis.summaries[profile.quantity]
 					scale = summary.peak_performance
 					base_performances.append(summary.peak_performance * (1.0 - summary.effective_start_up_time / summary.duration) / scale)
 					additional_performances.append(summary.peak_performance / scale - base_performances[-1])
@@ -439,15 +568,21 @@ class Benchmark:
 					position += 1
 					summary_legend_labels['native'] = 'gray'
 					analysis.plot(progress_axes, profile.quantity, scale, 'native', color = 'gray')
+					peak_performances[(profile.name, 'native')] = profile.performance(analysis, summary)
+					if profile.series is not None:
+						series_times.setdefault(profile.series, {}).setdefault('native', []).append((profile.series_value, 1.0 / (1000 * peak_performances[(profile.name, 'native')])))
+					interval_durations['native'] = [analysis.mean_interval_duration(interval_id) for interval_id in profile.intervals]
+					stage_times['native'] = [analysis.mean_stage_time(stage_id, profile.quantity) for stage_id in profile.stages]
+					counter_values['native'] = [analysis.mean_stage_time(counter_id, profile.quantity) for counter_id in profile.counters]
 
 				# Other executions
 				event_axis_shift = 0.0
-				for env in self.envs:
-					if env == 'native':
+				for env in sorted(self.envs):
+					if env == 'native' or not profile.enabled(env):
 						continue
 					with open(os.path.join(base_dir, 'out', self.name, '{profile}_{env}.txt'.format(profile = profile.name, env = env)), 'r') as file:
 						analysis = Analysis(file)
-					summary = analysis.summaries[profile.name]
+					summary = analysis.summaries[profile.quantity]
 					base_performances.append(summary.peak_performance * (1.0 - summary.effective_start_up_time / summary.duration) / scale)
 					additional_performances.append(summary.peak_performance / scale - base_performances[-1])
 					start_up_times.append(summary.start_up_time/1000)
@@ -456,6 +591,12 @@ class Benchmark:
 					summary_positions.append(position)
 					position += 1
 					analysis.plot(progress_axes, profile.quantity, scale, env, color = summary_legend_labels[env])
+					peak_performances[(profile.name, env)] = profile.performance(analysis, summary)
+					if profile.series is not None:
+						series_times.setdefault(profile.series, {}).setdefault(env, []).append((profile.series_value, 1.0 / (1000 * peak_performances[(profile.name, env)])))
+					interval_durations[env] = [analysis.mean_interval_duration(interval_id) for interval_id in profile.intervals]
+					stage_times[env] = [analysis.mean_stage_time(stage_id, profile.quantity) for stage_id in profile.stages]
+					counter_values[env] = [analysis.mean_stage_time(counter_id, profile.quantity) for counter_id in profile.counters]
 					
 #					if len(analysis.events) > 0:
 #						event_axis_shift -= 0.2;
@@ -480,10 +621,161 @@ class Benchmark:
 				plt.close(progress_figure)
 				
 				overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, '{profile}.{format}'.format(profile = profile.name, format = format))))
+
+				# Mean durations of the intervals the profile asks for, grouped by interval
+				if len(profile.intervals) > 0 and len(interval_durations) > 0:
+					intervals_figure = plt.figure()
+					intervals_figure.set_tight_layout(True)
+					intervals_axes = intervals_figure.add_subplot()
+					intervals_axes.set_title('{benchmark} {profile} intervals'.format(benchmark = self.name, profile = profile.name))
+					width = 1.0 / (len(interval_durations) + 1)
+					for index, (env, durations) in enumerate(interval_durations.items()):
+						intervals_axes.bar([slot + index * width for slot in range(len(profile.intervals))], [duration/1000 for duration in durations], width, color = summary_legend_labels[env], label = env)
+					intervals_axes.set_xticks([slot + (len(interval_durations) - 1) * width / 2 for slot in range(len(profile.intervals))])
+					intervals_axes.set_xticklabels(profile.intervals)
+					intervals_axes.set_ylabel('Mean duration [ms]')
+					intervals_axes.legend(loc = 'upper right')
+					with open(os.path.join(base_dir, 'out', self.name, '{profile}_intervals.{format}'.format(profile = profile.name, format = format)), 'w') as file:
+						intervals_figure.savefig(file, format = format)
+					plt.close(intervals_figure)
+					overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, '{profile}_intervals.{format}'.format(profile = profile.name, format = format))))
 				
+				# Time per stage and unit of the quantity, next to the slowdown of each stage relative to native
+				if len(profile.stages) > 0 and len(stage_times) > 0:
+					stages_figure = plt.figure(figsize = (12.8, 4.8))
+					stages_figure.set_tight_layout(True)
+					stage_times_axes = stages_figure.add_subplot(1, 2, 1)
+					stage_times_axes.set_title('{benchmark} {profile} stages'.format(benchmark = self.name, profile = profile.name))
+					slowdown_axes = stages_figure.add_subplot(1, 2, 2)
+					slowdown_axes.set_title('{benchmark} {profile} stage slowdown'.format(benchmark = self.name, profile = profile.name))
+					width = 1.0 / (len(stage_times) + 1)
+					for index, (env, times) in enumerate(stage_times.items()):
+						stage_times_axes.bar([slot + index * width for slot in range(len(profile.stages))], times, width, color = summary_legend_labels[env], label = env)
+						if 'native' in stage_times and env != 'native':
+							slowdowns = [time / native_time if native_time > 0 else 0.0 for time, native_time in zip(times, stage_times['native'])]
+							slowdown_axes.bar([slot + index * width for slot in range(len(profile.stages))], slowdowns, width, color = summary_legend_labels[env], label = env)
+					for axes in [stage_times_axes, slowdown_axes]:
+						axes.set_xticks([slot + (len(stage_times) - 1) * width / 2 for slot in range(len(profile.stages))])
+						axes.set_xticklabels(profile.stages, rotation = 45, horizontalalignment = 'right')
+					stage_times_axes.set_ylabel('Time per {} [ms]'.format(profile.quantity.rstrip('s')))
+					stage_times_axes.legend(loc = 'upper right')
+					slowdown_axes.axhline(1.0, color = 'gray', linestyle = 'dashed')
+					slowdown_axes.set_ylabel('Slowdown vs. native')
+					with open(os.path.join(base_dir, 'out', self.name, '{profile}_stages.{format}'.format(profile = profile.name, format = format)), 'w') as file:
+						stages_figure.savefig(file, format = format)
+					plt.close(stages_figure)
+					overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, '{profile}_stages.{format}'.format(profile = profile.name, format = format))))
+
+				# Counted events per unit of the quantity
+				if len(profile.counters) > 0 and len(counter_values) > 0:
+					counters_figure = plt.figure()
+					counters_figure.set_tight_layout(True)
+					counters_axes = counters_figure.add_subplot()
+					counters_axes.set_title('{benchmark} {profile} counters'.format(benchmark = self.name, profile = profile.name))
+					width = 1.0 / (len(counter_values) + 1)
+					for index, (env, values) in enumerate(counter_values.items()):
+						counters_axes.bar([slot + index * width for slot in range(len(profile.counters))], values, width, color = summary_legend_labels[env], label = env)
+					counters_axes.set_xticks([slot + (len(counter_values) - 1) * width / 2 for slot in range(len(profile.counters))])
+					counters_axes.set_xticklabels(profile.counters, rotation = 45, horizontalalignment = 'right')
+					counters_axes.set_ylabel('Mean per {}'.format(profile.quantity.rstrip('s')))
+					counters_axes.legend(loc = 'upper right')
+					with open(os.path.join(base_dir, 'out', self.name, '{profile}_counters.{format}'.format(profile = profile.name, format = format)), 'w') as file:
+						counters_figure.savefig(file, format = format)
+					plt.close(counters_figure)
+					overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, '{profile}_counters.{format}'.format(profile = profile.name, format = format))))
+
+				# Aggregate throughput and per-copy slowdown of simultaneous copies
+				if self.copies > 1:
+					copies_figure = plt.figure()
+					copies_figure.set_tight_layout(True)
+					throughput_axes = copies_figure.add_subplot(1, 2, 1)
+					throughput_axes.set_title('{profile} throughput'.format(profile = profile.name))
+					slowdown_axes = copies_figure.add_subplot(1, 2, 2)
+					slowdown_axes.set_title('{profile} per-copy slowdown'.format(profile = profile.name))
+					for env in sorted(self.envs):
+						if not (env == 'native' or base_env(env) in engine_envs) or not profile.enabled(env):
+							continue
+						counts = []
+						performances = []
+						for copies in copy_counts(self.copies):
+							file_name = '{profile}_{env}.txt' if copies == 1 else '{profile}_{env}_x{copies}.txt'
+							try:
+								with open(os.path.join(base_dir, 'out', self.name, file_name.format(profile = profile.name, env = env, copies = copies)), 'r') as file:
+									performance = Analysis(file).summaries[profile.quantity].peak_performance
+							except (OSError, KeyError):
+								continue
+							counts.append(copies)
+							performances.append(performance)
+						if len(counts) == 0 or counts[0] != 1 or performances[0] <= 0:
+							continue
+						throughput_axes.plot(counts, [performance / performances[0] for performance in performances], marker = 'o', color = summary_legend_labels[env], label = env)
+						slowdown_axes.plot(counts, [copies * performances[0] / performance for copies, performance in zip(counts, performances)], marker = 'o', color = summary_legend_labels[env], label = env)
+					for axes in throughput_axes, slowdown_axes:
+						axes.set_xscale('log', base = 2)
+						axes.set_xlabel('Copies')
+						axes.set_ylim(ymin = 0)
+					throughput_axes.set_ylabel('Aggregate throughput relative to one copy')
+					slowdown_axes.set_ylabel('Slowdown per copy')
+					throughput_axes.legend(loc = 'upper left')
+					with open(os.path.join(base_dir, 'out', self.name, '{profile}_copies.{format}'.format(profile = profile.name, format = format)), 'w') as file:
+						copies_figure.savefig(file, format = format)
+					plt.close(copies_figure)
+					overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, '{profile}_copies.{format}'.format(profile = profile.name, format = format))))
+
 				summary_ticks[-1] = (summary_ticks[-1] + position - 1) / 2
 				position += 1
 
+			# Scaling curves of the time per unit of the quantity over the series values
+			for series, env_times in series_times.items():
+				print('Analyzing {benchmark} {series} scaling'.format(benchmark = self.name, series = series))
+				scaling_figure = plt.figure()
+				scaling_figure.set_tight_layout(True)
+				scaling_axes = scaling_figure.add_subplot()
+				scaling_axes.set_title('{benchmark} {series} scaling'.format(benchmark = self.name, series = series))
+				for env, times in env_times.items():
+					times.sort()
+					scaling_axes.plot([value for value, time in times], [time for value, time in times], marker = 'o', color = summary_legend_labels[env], label = env)
+				scaling_axes.set_xscale('log')
+				scaling_axes.set_yscale('log')
+				scaling_axes.set_xlabel(series_labels[series])
+				scaling_axes.set_ylabel('Peak time per {} [ms]'.format(series_quantities[series].rstrip('s')))
+				scaling_axes.legend(loc = 'upper left')
+				with open(os.path.join(base_dir, 'out', self.name, '{series}_scaling.{format}'.format(series = series, format = format)), 'w') as file:
+					scaling_figure.savefig(file, format = format)
+				plt.close(scaling_figure)
+				overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, '{series}_scaling.{format}'.format(series = series, format = format))))
+
+			# Peak performance of profiles relative to their baseline profile in the same env
+			speedup_profiles = [profile for profile in self.profiles if profile.baseline is not None]
+			if len(speedup_profiles) > 0:
+				print('Analyzing {benchmark} speedups'.format(benchmark = self.name))
+				speedup_figure = plt.figure(figsize = (12.8, 4.8))
+				speedup_figure.set_tight_layout(True)
+				speedup_axes = speedup_figure.add_subplot()
+				speedup_axes.set_title('{benchmark} speedups'.format(benchmark = self.name))
+				speedup_envs = sorted(env for env in self.envs if any((profile.name, env) in peak_performances and (profile.baseline, env) in peak_performances for profile in speedup_profiles))
+				width = 1.0 / (len(speedup_envs) + 1)
+				for index, env in enumerate(speedup_envs):
+					slots = []
+					speedups = []
+					for slot, profile in enumerate(speedup_profiles):
+						performance = peak_performances.get((profile.name, env), 0.0)
+						baseline_performance = peak_performances.get((profile.baseline, env), 0.0)
+						if performance > 0 and baseline_performance > 0:
+							slots.append(slot + index * width)
+							speedups.append(performance / baseline_performance)
+							print('\t{profile} {env}: {speedup:.2f}x over {baseline}'.format(profile = profile.name, env = env, speedup = speedups[-1], baseline = profile.baseline))
+					speedup_axes.bar(slots, speedups, width, color = summary_legend_labels[env], label = env)
+				speedup_axes.set_xticks([slot + (len(speedup_envs) - 1) * width / 2 for slot in range(len(speedup_profiles))])
+				speedup_axes.set_xticklabels([profile.name for profile in speedup_profiles], rotation = 45, horizontalalignment = 'right')
+				speedup_axes.axhline(1.0, color = 'gray', linestyle = 'dashed')
+				speedup_axes.set_ylabel('Speedup over baseline profile')
+				speedup_axes.legend(loc = 'upper left')
+				with open(os.path.join(base_dir, 'out', self.name, 'speedup.{format}'.format(format = format)), 'w') as file:
+					speedup_figure.savefig(file, format = format)
+				plt.close(speedup_figure)
+				overview.write('\t<img src="{}">\n'.format(os.path.join(base_dir, 'out', self.name, 'speedup.{format}'.format(format = format))))
+
 			print('Generating {benchmark} summary and overview'.format(benchmark = self.name))
 
 			performances_axes.bar(summary_positions, base_performances, 1, color = summary_colors)
@@ -520,6 +812,7 @@ if __name__ == '__main__':
 	parser.add_argument('--d8', type = str, default = 'd8', help = 'Path to V8 shell (default: d8)')
 	parser.add_argument('--node', type = str, default = 'node', help = 'Path to Node.js (default: node)')
 	parser.add_argument('--mozjs', type = str, default = 'js', help = 'Path to SpiderMonkey shell (default: js)')
+	parser.add_argument('--copies', '-c', type = int, default = 1, help = 'Also run up to this many simultaneous copies natively and in JS shells to measure contention (default: 1)')
 	parser.add_argument('benchmarks', metavar = '<benchmark>', type = str, choices = allowed_benchmarks, default = allowed_benchmarks, nargs = '*', help = 'The name(s) of the benchmark(s) to run')
 	args = parser.parse_args()
 	import matplotlib
@@ -530,10 +823,10 @@ if __name__ == '__main__':
 	if len(args.env) == 0:
 		args.env = allowed_envs
 	if 'build' in args.step:
-		Benchmark.build_tools(args.env, args.verbose)
+		Benchmark.build_tools(args.env, args.verbose, args.copies)
 	for name in args.benchmarks:
 		#try:
-			benchmark = Benchmark(name, args.env, args.d8, args.node, args.mozjs)
+			benchmark = Benchmark(name, args.env, args.d8, args.node, args.mozjs, args.copies)
 			benchmark.set_verbose(args.verbose)
 			benchmark.set_run_profiler(args.perf)
 			if 'build' in args.step:
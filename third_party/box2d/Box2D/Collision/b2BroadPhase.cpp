@@ -31,10 +31,18 @@ b2BroadPhase::b2BroadPhase()
 	m_moveCapacity = 16;
 	m_moveCount = 0;
 	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+
+	m_batchedQueries = false;
+	m_queryCapacity = 0;
+	m_queryAABBs = NULL;
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
+	if (m_queryAABBs)
+	{
+		b2Free(m_queryAABBs);
+	}
 	b2Free(m_moveBuffer);
 	b2Free(m_pairBuffer);
 }
@@ -120,3 +128,21 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 
 	return true;
 }
+
+// emscripten - batched pair queries and tree rebuild
+// This is called from b2DynamicTree::QueryBatch with the index into the compacted move buffer.
+bool b2BroadPhase::QueryCallback(int32 queryIndex, int32 proxyId)
+{
+	m_queryProxyId = m_moveBuffer[queryIndex];
+	return QueryCallback(proxyId);
+}
+
+void b2BroadPhase::RebuildTree()
+{
+	m_tree.RebuildTopDown();
+}
+
+void b2BroadPhase::ReorderTree()
+{
+	m_tree.ReorderDepthFirst();
+}
@@ -102,6 +102,19 @@ public:
 	/// Get the quality metric of the embedded tree.
 	float32 GetTreeQuality() const;
 
+	// emscripten - batched pair queries and tree rebuild
+	/// Let UpdatePairs query the tree for all moved proxies in one batch instead of one by one.
+	/// The reported pairs are the same.
+	void SetBatchedQueries(bool flag) { m_batchedQueries = flag; }
+	bool GetBatchedQueries() const { return m_batchedQueries; }
+
+	/// Rebuild the embedded tree top down with the surface area heuristic. This does not
+	/// change proxy ids or pairs.
+	void RebuildTree();
+
+	/// Put the internal nodes of the embedded tree into depth first order.
+	void ReorderTree();
+
 private:
 
 	friend class b2DynamicTree;
@@ -110,6 +123,7 @@ private:
 	void UnBufferMove(int32 proxyId);
 
 	bool QueryCallback(int32 proxyId);
+	bool QueryCallback(int32 queryIndex, int32 proxyId);
 
 	b2DynamicTree m_tree;
 
@@ -124,6 +138,10 @@ private:
 	int32 m_pairCount;
 
 	int32 m_queryProxyId;
+
+	bool m_batchedQueries;
+	b2AABB* m_queryAABBs;
+	int32 m_queryCapacity;
 };
 
 /// This is used to sort pairs.
@@ -185,21 +203,52 @@ void b2BroadPhase::UpdatePairs(T* callback)
 	// Reset pair buffer
 	m_pairCount = 0;
 
-	// Perform tree queries for all moving proxies.
-	for (int32 i = 0; i < m_moveCount; ++i)
+	if (m_batchedQueries)
 	{
-		m_queryProxyId = m_moveBuffer[i];
-		if (m_queryProxyId == e_nullProxy)
+		// emscripten - compact the move buffer and query the fat AABBs of all moving proxies
+		// at once. QueryCallback(queryIndex, proxyId) maps the query back to the proxy.
+		int32 queryCount = 0;
+		for (int32 i = 0; i < m_moveCount; ++i)
 		{
-			continue;
+			if (m_moveBuffer[i] != e_nullProxy)
+			{
+				m_moveBuffer[queryCount] = m_moveBuffer[i];
+				++queryCount;
+			}
 		}
 
-		// We have to query the tree with the fat AABB so that
-		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+		if (queryCount > m_queryCapacity)
+		{
+			b2Free(m_queryAABBs);
+			m_queryCapacity = m_moveCapacity;
+			m_queryAABBs = (b2AABB*)b2Alloc(m_queryCapacity * sizeof(b2AABB));
+		}
 
-		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
+		for (int32 i = 0; i < queryCount; ++i)
+		{
+			m_queryAABBs[i] = m_tree.GetFatAABB(m_moveBuffer[i]);
+		}
+
+		m_tree.QueryBatch(this, m_queryAABBs, queryCount);
+	}
+	else
+	{
+		// Perform tree queries for all moving proxies.
+		for (int32 i = 0; i < m_moveCount; ++i)
+		{
+			m_queryProxyId = m_moveBuffer[i];
+			if (m_queryProxyId == e_nullProxy)
+			{
+				continue;
+			}
+
+			// We have to query the tree with the fat AABB so that
+			// we don't fail to create a pair that may touch later.
+			const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+
+			// Query tree, create pairs and add them pair buffer.
+			m_tree.Query(this, fatAABB);
+		}
 	}
 
 	// Reset move buffer
@@ -769,3 +769,273 @@ void b2DynamicTree::RebuildBottomUp()
 
 	Validate();
 }
+
+// emscripten - top down rebuild and depth first node order
+void b2DynamicTree::RebuildTopDown()
+{
+	int32* leaves = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 count = 0;
+
+	// Build array of leaves. Free the rest.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// free node in pool
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			m_nodes[i].parent = b2_nullNode;
+			leaves[count] = i;
+			++count;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	// Sort the free list, so that the build hands out ascending indices in depth first order.
+	m_freeList = b2_nullNode;
+	for (int32 i = m_nodeCapacity - 1; i >= 0; --i)
+	{
+		if (m_nodes[i].height == -1)
+		{
+			m_nodes[i].next = m_freeList;
+			m_freeList = i;
+		}
+	}
+
+	m_root = b2_nullNode;
+	if (count > 0)
+	{
+		m_root = BuildTopDown(leaves, count);
+		m_nodes[m_root].parent = b2_nullNode;
+	}
+	b2Free(leaves);
+
+	Validate();
+}
+
+int32 b2DynamicTree::BuildTopDown(int32* leaves, int32 count)
+{
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	// Split along the axis with the largest extent of the leaf centers.
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 c = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, c);
+		upper = b2Max(upper, c);
+	}
+
+	b2Vec2 extent = upper - lower;
+	int32 axis = extent.x >= extent.y ? 0 : 1;
+	float32 origin = lower(axis);
+	float32 size = extent(axis);
+
+	int32 split = count / 2;
+	if (size > 0.0f)
+	{
+		// Bin the centers and pick the boundary with the least surface area cost. The first and
+		// the last bin are never empty, so there always is a boundary.
+		const int32 binCount = 16;
+		const float32 scale = binCount / size;
+		int32 binCounts[binCount];
+		b2AABB binAABBs[binCount];
+		for (int32 b = 0; b < binCount; ++b)
+		{
+			binCounts[b] = 0;
+		}
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			const b2AABB& aabb = m_nodes[leaves[i]].aabb;
+			int32 b = b2Min(int32((aabb.GetCenter()(axis) - origin) * scale), binCount - 1);
+			if (binCounts[b] == 0)
+			{
+				binAABBs[b] = aabb;
+			}
+			else
+			{
+				binAABBs[b].Combine(aabb);
+			}
+			++binCounts[b];
+		}
+
+		// Cost of everything above each boundary.
+		float32 upperCosts[binCount];
+		b2AABB upperAABB;
+		int32 upperCount = 0;
+		for (int32 b = binCount - 1; b > 0; --b)
+		{
+			if (binCounts[b] > 0)
+			{
+				if (upperCount == 0)
+				{
+					upperAABB = binAABBs[b];
+				}
+				else
+				{
+					upperAABB.Combine(binAABBs[b]);
+				}
+				upperCount += binCounts[b];
+			}
+			upperCosts[b] = upperCount > 0 ? upperCount * upperAABB.GetPerimeter() : b2_maxFloat;
+		}
+
+		float32 bestCost = b2_maxFloat;
+		int32 bestBin = 0;
+		b2AABB lowerAABB;
+		int32 lowerCount = 0;
+		for (int32 b = 0; b < binCount - 1; ++b)
+		{
+			if (binCounts[b] > 0)
+			{
+				if (lowerCount == 0)
+				{
+					lowerAABB = binAABBs[b];
+				}
+				else
+				{
+					lowerAABB.Combine(binAABBs[b]);
+				}
+				lowerCount += binCounts[b];
+			}
+			if (lowerCount > 0 && upperCosts[b + 1] < b2_maxFloat)
+			{
+				float32 cost = lowerCount * lowerAABB.GetPerimeter() + upperCosts[b + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestBin = b;
+				}
+			}
+		}
+
+		// Partition the leaves at the chosen boundary.
+		int32 i = 0;
+		int32 j = count - 1;
+		while (i <= j)
+		{
+			const b2AABB& aabb = m_nodes[leaves[i]].aabb;
+			int32 b = b2Min(int32((aabb.GetCenter()(axis) - origin) * scale), binCount - 1);
+			if (b <= bestBin)
+			{
+				++i;
+			}
+			else
+			{
+				b2Swap(leaves[i], leaves[j]);
+				--j;
+			}
+		}
+		split = i;
+	}
+
+	// Allocate the parent before its children to get a depth first order.
+	int32 index = AllocateNode();
+	int32 child1 = BuildTopDown(leaves, split);
+	int32 child2 = BuildTopDown(leaves + split, count - split);
+
+	b2TreeNode* node = m_nodes + index;
+	node->child1 = child1;
+	node->child2 = child2;
+	node->height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
+	node->aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	node->parent = b2_nullNode;
+
+	m_nodes[child1].parent = index;
+	m_nodes[child2].parent = index;
+
+	return index;
+}
+
+void b2DynamicTree::ReorderDepthFirst()
+{
+	if (m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	// Internal nodes in depth first order.
+	int32* order = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 count = 0;
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root);
+	while (stack.GetCount() > 0)
+	{
+		int32 index = stack.Pop();
+		const b2TreeNode* node = m_nodes + index;
+		if (node->IsLeaf())
+		{
+			continue;
+		}
+
+		order[count] = index;
+		++count;
+		stack.Push(node->child2);
+		stack.Push(node->child1);
+	}
+
+	// The k-th node in depth first order moves to the k-th smallest internal index.
+	int32* remap = (int32*)b2Alloc(m_nodeCapacity * sizeof(int32));
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		remap[i] = i;
+	}
+
+	b2TreeNode* nodes = (b2TreeNode*)b2Alloc(count * sizeof(b2TreeNode));
+	int32 k = 0;
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height > 0)
+		{
+			remap[order[k]] = i;
+			++k;
+		}
+	}
+	b2Assert(k == count);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		nodes[i] = m_nodes[order[i]];
+	}
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_nodes[remap[order[i]]] = nodes[i];
+	}
+
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		b2TreeNode* node = m_nodes + i;
+		if (node->height < 0)
+		{
+			continue;
+		}
+
+		if (node->parent != b2_nullNode)
+		{
+			node->parent = remap[node->parent];
+		}
+		if (node->IsLeaf() == false)
+		{
+			node->child1 = remap[node->child1];
+			node->child2 = remap[node->child2];
+		}
+	}
+	m_root = remap[m_root];
+
+	b2Free(nodes);
+	b2Free(remap);
+	b2Free(order);
+
+	Validate();
+}
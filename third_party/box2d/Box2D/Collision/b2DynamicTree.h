@@ -118,8 +118,33 @@ public:
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
+	// emscripten - bulk rebuild, node order and batched queries
+	/// Rebuild the tree top down from all proxies, splitting by the surface area heuristic
+	/// over binned centroids. This is O(n log n) and gives better trees than incremental
+	/// insertion. The internal nodes are allocated in depth first order and proxy ids stay.
+	void RebuildTopDown();
+
+	/// Renumber the internal nodes in depth first order among the indices they already use,
+	/// so that queries walk the node pool mostly forward. Leaves are proxies and keep their ids.
+	void ReorderDepthFirst();
+
+	/// Query count AABBs at once. Groups of four queries share one traversal that tests the
+	/// node AABBs with SIMD. callback->QueryCallback(queryIndex, proxyId) is called for each
+	/// overlap, per query in the same order as Query. Returning false ends that query only.
+	template <typename T>
+	void QueryBatch(T* callback, const b2AABB* aabbs, int32 count) const;
+
 private:
 
+	typedef bool b2QueryBatchFcn(void* callback, int32 queryIndex, int32 proxyId);
+
+	template <typename T>
+	static bool QueryBatchCallback(void* callback, int32 queryIndex, int32 proxyId);
+
+	void RunQueryBatch(b2QueryBatchFcn* fcn, void* callback, const b2AABB* aabbs, int32 count) const;
+
+	int32 BuildTopDown(int32* leaves, int32 count);
+
 	int32 AllocateNode();
 	void FreeNode(int32 node);
 
@@ -195,6 +220,18 @@ inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 	}
 }
 
+template <typename T>
+inline bool b2DynamicTree::QueryBatchCallback(void* callback, int32 queryIndex, int32 proxyId)
+{
+	return ((T*)callback)->QueryCallback(queryIndex, proxyId);
+}
+
+template <typename T>
+inline void b2DynamicTree::QueryBatch(T* callback, const b2AABB* aabbs, int32 count) const
+{
+	RunQueryBatch(&QueryBatchCallback<T>, callback, aabbs, count);
+}
+
 template <typename T>
 inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) const
 {
@@ -0,0 +1,188 @@
+/*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// emscripten - batched tree queries
+//
+// Four queries walk the tree together. Every node AABB is tested against the four query AABBs
+// in the lanes of one vector and the node is skipped once no active query overlaps it, so the
+// upper levels of the tree are loaded once per packet instead of once per query.
+
+#include <Box2D/Collision/b2DynamicTree.h>
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define B2_SIMD_SSE2 1
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define B2_SIMD_WASM 1
+#endif
+
+const int32 b2_queryPacketWidth = 4;
+
+// b2TestOverlap(node, query) for the queries of a packet as a bit mask. The comparisons are
+// the negated ones of b2TestOverlap, which agree for all non NaN bounds.
+#if B2_SIMD_SSE2
+
+struct b2QueryPacket
+{
+	__m128 lowerX, lowerY, upperX, upperY;
+};
+
+static inline void b2LoadPacket(b2QueryPacket* packet, const float32* lowerX, const float32* lowerY, const float32* upperX, const float32* upperY)
+{
+	packet->lowerX = _mm_loadu_ps(lowerX);
+	packet->lowerY = _mm_loadu_ps(lowerY);
+	packet->upperX = _mm_loadu_ps(upperX);
+	packet->upperY = _mm_loadu_ps(upperY);
+}
+
+static inline int32 b2OverlapMask(const b2QueryPacket& packet, const b2AABB& aabb)
+{
+	__m128 x = _mm_and_ps(_mm_cmpge_ps(_mm_set1_ps(aabb.upperBound.x), packet.lowerX), _mm_cmpge_ps(packet.upperX, _mm_set1_ps(aabb.lowerBound.x)));
+	__m128 y = _mm_and_ps(_mm_cmpge_ps(_mm_set1_ps(aabb.upperBound.y), packet.lowerY), _mm_cmpge_ps(packet.upperY, _mm_set1_ps(aabb.lowerBound.y)));
+	return _mm_movemask_ps(_mm_and_ps(x, y));
+}
+
+#elif B2_SIMD_WASM
+
+struct b2QueryPacket
+{
+	v128_t lowerX, lowerY, upperX, upperY;
+};
+
+static inline void b2LoadPacket(b2QueryPacket* packet, const float32* lowerX, const float32* lowerY, const float32* upperX, const float32* upperY)
+{
+	packet->lowerX = wasm_v128_load(lowerX);
+	packet->lowerY = wasm_v128_load(lowerY);
+	packet->upperX = wasm_v128_load(upperX);
+	packet->upperY = wasm_v128_load(upperY);
+}
+
+static inline int32 b2OverlapMask(const b2QueryPacket& packet, const b2AABB& aabb)
+{
+	v128_t x = wasm_v128_and(wasm_f32x4_ge(wasm_f32x4_splat(aabb.upperBound.x), packet.lowerX), wasm_f32x4_ge(packet.upperX, wasm_f32x4_splat(aabb.lowerBound.x)));
+	v128_t y = wasm_v128_and(wasm_f32x4_ge(wasm_f32x4_splat(aabb.upperBound.y), packet.lowerY), wasm_f32x4_ge(packet.upperY, wasm_f32x4_splat(aabb.lowerBound.y)));
+	return wasm_i32x4_bitmask(wasm_v128_and(x, y));
+}
+
+#else
+
+struct b2QueryPacket
+{
+	float32 lowerX[b2_queryPacketWidth], lowerY[b2_queryPacketWidth];
+	float32 upperX[b2_queryPacketWidth], upperY[b2_queryPacketWidth];
+};
+
+static inline void b2LoadPacket(b2QueryPacket* packet, const float32* lowerX, const float32* lowerY, const float32* upperX, const float32* upperY)
+{
+	memcpy(packet->lowerX, lowerX, sizeof(packet->lowerX));
+	memcpy(packet->lowerY, lowerY, sizeof(packet->lowerY));
+	memcpy(packet->upperX, upperX, sizeof(packet->upperX));
+	memcpy(packet->upperY, upperY, sizeof(packet->upperY));
+}
+
+static inline int32 b2OverlapMask(const b2QueryPacket& packet, const b2AABB& aabb)
+{
+	int32 mask = 0;
+	for (int32 i = 0; i < b2_queryPacketWidth; ++i)
+	{
+		if (aabb.upperBound.x >= packet.lowerX[i] && packet.upperX[i] >= aabb.lowerBound.x &&
+			aabb.upperBound.y >= packet.lowerY[i] && packet.upperY[i] >= aabb.lowerBound.y)
+		{
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+#endif
+
+void b2DynamicTree::RunQueryBatch(b2QueryBatchFcn* fcn, void* callback, const b2AABB* aabbs, int32 count) const
+{
+	b2GrowableStack<int32, 256> stack;
+
+	for (int32 base = 0; base < count; base += b2_queryPacketWidth)
+	{
+		// Unused lanes get an inverted box that overlaps nothing.
+		float32 lowerX[b2_queryPacketWidth], lowerY[b2_queryPacketWidth];
+		float32 upperX[b2_queryPacketWidth], upperY[b2_queryPacketWidth];
+		int32 active = 0;
+		for (int32 i = 0; i < b2_queryPacketWidth; ++i)
+		{
+			if (base + i < count)
+			{
+				const b2AABB& aabb = aabbs[base + i];
+				lowerX[i] = aabb.lowerBound.x;
+				lowerY[i] = aabb.lowerBound.y;
+				upperX[i] = aabb.upperBound.x;
+				upperY[i] = aabb.upperBound.y;
+				active |= 1 << i;
+			}
+			else
+			{
+				lowerX[i] = b2_maxFloat;
+				lowerY[i] = b2_maxFloat;
+				upperX[i] = -b2_maxFloat;
+				upperY[i] = -b2_maxFloat;
+			}
+		}
+
+		b2QueryPacket packet;
+		b2LoadPacket(&packet, lowerX, lowerY, upperX, upperY);
+
+		stack.Push(m_root);
+		while (stack.GetCount() > 0 && active != 0)
+		{
+			int32 nodeId = stack.Pop();
+			if (nodeId == b2_nullNode)
+			{
+				continue;
+			}
+
+			const b2TreeNode* node = m_nodes + nodeId;
+
+			int32 mask = b2OverlapMask(packet, node->aabb) & active;
+			if (mask == 0)
+			{
+				continue;
+			}
+
+			if (node->IsLeaf())
+			{
+				for (int32 i = 0; i < b2_queryPacketWidth; ++i)
+				{
+					if ((mask & (1 << i)) && fcn(callback, base + i, nodeId) == false)
+					{
+						active &= ~(1 << i);
+					}
+				}
+			}
+			else
+			{
+				stack.Push(node->child1);
+				stack.Push(node->child2);
+			}
+		}
+
+		// An early exit leaves nodes behind.
+		while (stack.GetCount() > 0)
+		{
+			stack.Pop();
+		}
+	}
+}
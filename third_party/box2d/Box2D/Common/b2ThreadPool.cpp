@@ -0,0 +1,217 @@
+/*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Math.h>
+
+#if B2_THREADS
+
+static inline uint64_t b2PackRange(int32 begin, int32 end)
+{
+	return (uint64_t(uint32(begin)) << 32) | uint64_t(uint32(end));
+}
+
+static inline int32 b2RangeBegin(uint64_t range)
+{
+	return int32(range >> 32);
+}
+
+static inline int32 b2RangeEnd(uint64_t range)
+{
+	return int32(range & 0xffffffffu);
+}
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	m_threadCount = b2Max(threadCount, 1);
+	m_ranges = new b2ThreadRange[m_threadCount];
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		m_ranges[i].range.store(0);
+	}
+	m_task = NULL;
+	m_generation = 0;
+	m_busyCount = 0;
+	m_exit = false;
+
+	m_threads.reserve(m_threadCount - 1);
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		m_threads.push_back(std::thread(&b2ThreadPool::WorkerMain, this, i));
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_exit = true;
+		++m_generation;
+	}
+	m_wakeUp.notify_all();
+	for (size_t i = 0; i < m_threads.size(); ++i)
+	{
+		m_threads[i].join();
+	}
+	delete [] m_ranges;
+}
+
+void b2ThreadPool::Run(b2ThreadTask* task, int32 count)
+{
+	if (m_threadCount == 1 || count <= 1)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			task->Execute(i, 0);
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		int32 begin = int32(int64_t(count) * i / m_threadCount);
+		int32 end = int32(int64_t(count) * (i + 1) / m_threadCount);
+		m_ranges[i].range.store(b2PackRange(begin, end));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_busyCount = m_threadCount - 1;
+		++m_generation;
+	}
+	m_wakeUp.notify_all();
+
+	Work(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_busyCount > 0)
+	{
+		m_done.wait(lock);
+	}
+	m_task = NULL;
+}
+
+void b2ThreadPool::WorkerMain(int32 threadIndex)
+{
+	uint32 generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_generation == generation)
+			{
+				m_wakeUp.wait(lock);
+			}
+			generation = m_generation;
+			if (m_exit)
+			{
+				return;
+			}
+		}
+
+		Work(threadIndex);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_busyCount == 0)
+		{
+			m_done.notify_one();
+		}
+	}
+}
+
+void b2ThreadPool::Work(int32 threadIndex)
+{
+	do
+	{
+		int32 index;
+		while (Pop(threadIndex, &index))
+		{
+			m_task->Execute(index, threadIndex);
+		}
+	}
+	while (Steal(threadIndex));
+}
+
+bool b2ThreadPool::Pop(int32 threadIndex, int32* index)
+{
+	std::atomic<uint64_t>& range = m_ranges[threadIndex].range;
+	uint64_t current = range.load();
+	for (;;)
+	{
+		int32 begin = b2RangeBegin(current);
+		int32 end = b2RangeEnd(current);
+		if (begin >= end)
+		{
+			return false;
+		}
+		if (range.compare_exchange_weak(current, b2PackRange(begin + 1, end)))
+		{
+			*index = begin;
+			return true;
+		}
+	}
+}
+
+bool b2ThreadPool::Steal(int32 threadIndex)
+{
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		std::atomic<uint64_t>& victim = m_ranges[(threadIndex + i) % m_threadCount].range;
+		uint64_t current = victim.load();
+		for (;;)
+		{
+			int32 begin = b2RangeBegin(current);
+			int32 end = b2RangeEnd(current);
+			if (begin >= end)
+			{
+				break;
+			}
+
+			// Take the back half, rounded up so that a single index can be stolen as well.
+			int32 middle = end - (end - begin + 1) / 2;
+			if (victim.compare_exchange_weak(current, b2PackRange(begin, middle)))
+			{
+				// Nobody steals from an empty block, so the own block can be replaced safely.
+				m_ranges[threadIndex].range.store(b2PackRange(middle, end));
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+#else
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	B2_NOT_USED(threadCount);
+	m_threadCount = 1;
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+}
+
+void b2ThreadPool::Run(b2ThreadTask* task, int32 count)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		task->Execute(i, 0);
+	}
+}
+
+#endif
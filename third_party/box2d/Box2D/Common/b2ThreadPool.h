@@ -0,0 +1,96 @@
+/*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+
+// Emscripten builds without pthreads cannot start threads, so the pool runs everything on the
+// calling thread there.
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define B2_THREADS 0
+#else
+#define B2_THREADS 1
+#endif
+
+#if B2_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+/// Implement this class to run independent pieces of work on a b2ThreadPool.
+class b2ThreadTask
+{
+public:
+	virtual ~b2ThreadTask() {}
+
+	/// Run the piece of work with the given index. threadIndex is in [0, thread count) and
+	/// identifies the thread, 0 being the thread that called b2ThreadPool::Run.
+	virtual void Execute(int32 index, int32 threadIndex) = 0;
+};
+
+/// A fixed set of worker threads for the solver. Every Run splits the indices into one
+/// contiguous block per thread. A thread that finished its block steals half of the
+/// remaining block of another thread, so uneven work is balanced without a shared queue.
+class b2ThreadPool
+{
+public:
+	/// Start threadCount - 1 workers, the thread calling Run is the remaining one.
+	b2ThreadPool(int32 threadCount);
+	~b2ThreadPool();
+
+	/// Get the number of threads including the calling thread.
+	int32 GetThreadCount() const { return m_threadCount; }
+
+	/// Execute the task for every index in [0, count) and return when all are done.
+	void Run(b2ThreadTask* task, int32 count);
+
+private:
+
+#if B2_THREADS
+	// The block of a thread packed as begin << 32 | end, so that the owner taking from the
+	// front and thieves taking from the back agree with a single compare and swap.
+	struct alignas(64) b2ThreadRange
+	{
+		std::atomic<uint64_t> range;
+	};
+
+	void WorkerMain(int32 threadIndex);
+	void Work(int32 threadIndex);
+	bool Pop(int32 threadIndex, int32* index);
+	bool Steal(int32 threadIndex);
+
+	b2ThreadRange* m_ranges;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	std::condition_variable m_done;
+	b2ThreadTask* m_task;
+	uint32 m_generation;
+	int32 m_busyCount;
+	bool m_exit;
+#endif
+
+	int32 m_threadCount;
+};
+
+#endif
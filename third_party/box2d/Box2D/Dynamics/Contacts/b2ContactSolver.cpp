@@ -51,6 +51,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_simdBodyColors = NULL;
+	m_simdConstraintColors = NULL;
+	m_simdConstraints = NULL;
+	m_simdConstraintCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -129,6 +133,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_simdConstraints)
+	{
+		m_allocator->Free(m_simdConstraints);
+		m_allocator->Free(m_simdConstraintColors);
+		m_allocator->Free(m_simdBodyColors);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -243,6 +253,11 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+	if (m_step.simdContactSolver)
+	{
+		PrepareSIMDConstraints();
+	}
 }
 
 void b2ContactSolver::WarmStart()
@@ -287,6 +302,12 @@ void b2ContactSolver::WarmStart()
 
 void b2ContactSolver::SolveVelocityConstraints()
 {
+	if (m_simdConstraints)
+	{
+		SolveVelocityConstraintsSIMD();
+		return;
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -597,6 +618,11 @@ void b2ContactSolver::SolveVelocityConstraints()
 
 void b2ContactSolver::StoreImpulses()
 {
+	if (m_simdConstraints)
+	{
+		StoreImpulsesSIMD();
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
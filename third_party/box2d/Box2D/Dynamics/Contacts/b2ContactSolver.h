@@ -27,6 +27,7 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2ContactConstraintSIMD;
 
 struct b2VelocityConstraintPoint
 {
@@ -80,6 +81,12 @@ public:
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	// emscripten - SIMD contact solver, used for the velocity constraints when
+	// m_step.simdContactSolver is set. See b2ContactSolverSIMD.cpp.
+	void PrepareSIMDConstraints();
+	void SolveVelocityConstraintsSIMD();
+	void StoreImpulsesSIMD();
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -88,6 +95,11 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	uint32* m_simdBodyColors;
+	int32* m_simdConstraintColors;
+	b2ContactConstraintSIMD* m_simdConstraints;
+	int32 m_simdConstraintCount;
 };
 
 #endif
@@ -0,0 +1,521 @@
+/*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// emscripten - SIMD contact solver
+//
+// The velocity constraints are graph coloured so that no two constraints of a color share a
+// body with mass, and every color is cut into batches of b2_simdWidth constraints that are
+// stored as structure of arrays. A batch is solved in the lanes of one vector with exactly the
+// operations of b2ContactSolver::SolveVelocityConstraints, so only the order in which the
+// constraints are solved differs from the scalar solver. The width is 4 on all platforms,
+// which keeps SSE2, Wasm simd128 and the portable fallback bit-identical to each other.
+
+#include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define B2_SIMD_SSE2 1
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define B2_SIMD_WASM 1
+#endif
+
+const int32 b2_simdWidth = 4;
+
+// Constraints that find no free color among these are solved alone in a batch of their own.
+const int32 b2_simdColorCount = 32;
+
+struct b2ContactConstraintSIMD
+{
+	int32 constraintIndex[b2_simdWidth];	// -1 for unused lanes
+	int32 indexA[b2_simdWidth];
+	int32 indexB[b2_simdWidth];
+	float32 twoPoints[b2_simdWidth];		// all bits set for two point manifolds
+	float32 normalX[b2_simdWidth], normalY[b2_simdWidth];
+	float32 friction[b2_simdWidth];
+	float32 invMassA[b2_simdWidth], invIA[b2_simdWidth];
+	float32 invMassB[b2_simdWidth], invIB[b2_simdWidth];
+	float32 K11[b2_simdWidth], K12[b2_simdWidth], K21[b2_simdWidth], K22[b2_simdWidth];
+	float32 normalMass11[b2_simdWidth], normalMass12[b2_simdWidth];
+	float32 normalMass21[b2_simdWidth], normalMass22[b2_simdWidth];
+
+	struct Point
+	{
+		float32 rAX[b2_simdWidth], rAY[b2_simdWidth];
+		float32 rBX[b2_simdWidth], rBY[b2_simdWidth];
+		float32 normalImpulse[b2_simdWidth];
+		float32 tangentImpulse[b2_simdWidth];
+		float32 normalMass[b2_simdWidth];
+		float32 tangentMass[b2_simdWidth];
+		float32 velocityBias[b2_simdWidth];
+	} points[b2_maxManifoldPoints];
+};
+
+// Minimal vector layer. Min and max follow b2Min and b2Max, also for signed zeros, and masks
+// have all bits of a lane set.
+#if B2_SIMD_SSE2
+
+typedef __m128 b2FloatW;
+
+static inline b2FloatW b2LoadW(const float32* a) { return _mm_loadu_ps(a); }
+static inline void b2StoreW(float32* a, b2FloatW b) { _mm_storeu_ps(a, b); }
+static inline b2FloatW b2SplatW(float32 a) { return _mm_set1_ps(a); }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm_add_ps(a, b); }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm_sub_ps(a, b); }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm_mul_ps(a, b); }
+static inline b2FloatW b2NegW(b2FloatW a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm_min_ps(a, b); }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm_max_ps(a, b); }
+static inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return _mm_cmpge_ps(a, b); }
+static inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { return _mm_and_ps(a, b); }
+static inline b2FloatW b2OrW(b2FloatW a, b2FloatW b) { return _mm_or_ps(a, b); }
+static inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+#elif B2_SIMD_WASM
+
+typedef v128_t b2FloatW;
+
+static inline b2FloatW b2LoadW(const float32* a) { return wasm_v128_load(a); }
+static inline void b2StoreW(float32* a, b2FloatW b) { wasm_v128_store(a, b); }
+static inline b2FloatW b2SplatW(float32 a) { return wasm_f32x4_splat(a); }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return wasm_f32x4_add(a, b); }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return wasm_f32x4_sub(a, b); }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return wasm_f32x4_mul(a, b); }
+static inline b2FloatW b2NegW(b2FloatW a) { return wasm_f32x4_neg(a); }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return wasm_f32x4_pmin(b, a); }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return wasm_f32x4_pmax(b, a); }
+static inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return wasm_f32x4_ge(a, b); }
+static inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { return wasm_v128_and(a, b); }
+static inline b2FloatW b2OrW(b2FloatW a, b2FloatW b) { return wasm_v128_or(a, b); }
+static inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b) { return wasm_v128_bitselect(a, b, mask); }
+
+#else
+
+struct b2FloatW
+{
+	float32 lane[b2_simdWidth];
+};
+
+static inline uint32 b2BitsW(float32 a) { uint32 b; memcpy(&b, &a, sizeof(b)); return b; }
+static inline float32 b2FromBitsW(uint32 a) { float32 b; memcpy(&b, &a, sizeof(b)); return b; }
+
+#define B2_LANES(expression) b2FloatW r; for (int32 i = 0; i < b2_simdWidth; ++i) { r.lane[i] = expression; } return r;
+
+static inline b2FloatW b2LoadW(const float32* a) { B2_LANES(a[i]) }
+static inline void b2StoreW(float32* a, b2FloatW b) { memcpy(a, b.lane, sizeof(b.lane)); }
+static inline b2FloatW b2SplatW(float32 a) { B2_LANES(a) }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { B2_LANES(a.lane[i] + b.lane[i]) }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { B2_LANES(a.lane[i] - b.lane[i]) }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { B2_LANES(a.lane[i] * b.lane[i]) }
+static inline b2FloatW b2NegW(b2FloatW a) { B2_LANES(-a.lane[i]) }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { B2_LANES(b2Min(a.lane[i], b.lane[i])) }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { B2_LANES(b2Max(a.lane[i], b.lane[i])) }
+static inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { B2_LANES(b2FromBitsW(a.lane[i] >= b.lane[i] ? 0xffffffffu : 0u)) }
+static inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { B2_LANES(b2FromBitsW(b2BitsW(a.lane[i]) & b2BitsW(b.lane[i]))) }
+static inline b2FloatW b2OrW(b2FloatW a, b2FloatW b) { B2_LANES(b2FromBitsW(b2BitsW(a.lane[i]) | b2BitsW(b.lane[i]))) }
+static inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b) { B2_LANES(b2BitsW(mask.lane[i]) ? a.lane[i] : b.lane[i]) }
+
+#undef B2_LANES
+
+#endif
+
+// b2Cross(a, b) of two vectors
+static inline b2FloatW b2CrossW(b2FloatW ax, b2FloatW ay, b2FloatW bx, b2FloatW by)
+{
+	return b2SubW(b2MulW(ax, by), b2MulW(ay, bx));
+}
+
+// Lane wise copy of the velocities of both bodies
+struct b2BodyVelocityW
+{
+	b2FloatW vx, vy, w;
+};
+
+// Relative normal or tangent velocity at a contact point with the order of operations of
+// b2Dot(vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA), direction).
+static inline b2FloatW b2RelativeVelocityW(const b2BodyVelocityW& a, const b2BodyVelocityW& b,
+										   const b2ContactConstraintSIMD::Point& point, b2FloatW dirX, b2FloatW dirY)
+{
+	b2FloatW rAX = b2LoadW(point.rAX), rAY = b2LoadW(point.rAY);
+	b2FloatW rBX = b2LoadW(point.rBX), rBY = b2LoadW(point.rBY);
+	b2FloatW dvX = b2SubW(b2SubW(b2AddW(b.vx, b2MulW(b2NegW(b.w), rBY)), a.vx), b2MulW(b2NegW(a.w), rAY));
+	b2FloatW dvY = b2SubW(b2SubW(b2AddW(b.vy, b2MulW(b.w, rBX)), a.vy), b2MulW(a.w, rAX));
+	return b2AddW(b2MulW(dvX, dirX), b2MulW(dvY, dirY));
+}
+
+// Apply the impulse P at a single contact point.
+static inline void b2ApplyImpulseW(b2BodyVelocityW* a, b2BodyVelocityW* b, b2FloatW mA, b2FloatW iA, b2FloatW mB, b2FloatW iB,
+								   const b2ContactConstraintSIMD::Point& point, b2FloatW PX, b2FloatW PY)
+{
+	a->vx = b2SubW(a->vx, b2MulW(mA, PX));
+	a->vy = b2SubW(a->vy, b2MulW(mA, PY));
+	a->w = b2SubW(a->w, b2MulW(iA, b2CrossW(b2LoadW(point.rAX), b2LoadW(point.rAY), PX, PY)));
+
+	b->vx = b2AddW(b->vx, b2MulW(mB, PX));
+	b->vy = b2AddW(b->vy, b2MulW(mB, PY));
+	b->w = b2AddW(b->w, b2MulW(iB, b2CrossW(b2LoadW(point.rBX), b2LoadW(point.rBY), PX, PY)));
+}
+
+void b2ContactSolver::PrepareSIMDConstraints()
+{
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bodyCount = b2Max(bodyCount, b2Max(vc->indexA, vc->indexB) + 1);
+	}
+
+	// Greedy coloring in constraint order. Bodies without mass are only read, so they may
+	// appear in several lanes of a batch.
+	m_simdBodyColors = (uint32*)m_allocator->Allocate(bodyCount * sizeof(uint32));
+	m_simdConstraintColors = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	memset(m_simdBodyColors, 0, bodyCount * sizeof(uint32));
+
+	int32 colorCounts[b2_simdColorCount] = {0};
+	int32 overflowCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bool movableA = vc->invMassA != 0.0f || vc->invIA != 0.0f;
+		bool movableB = vc->invMassB != 0.0f || vc->invIB != 0.0f;
+		uint32 used = (movableA ? m_simdBodyColors[vc->indexA] : 0) | (movableB ? m_simdBodyColors[vc->indexB] : 0);
+
+		int32 color = 0;
+		while (color < b2_simdColorCount && (used & (1u << color)))
+		{
+			++color;
+		}
+
+		if (color == b2_simdColorCount)
+		{
+			m_simdConstraintColors[i] = -1;
+			++overflowCount;
+			continue;
+		}
+
+		m_simdConstraintColors[i] = color;
+		++colorCounts[color];
+		if (movableA)
+		{
+			m_simdBodyColors[vc->indexA] |= 1u << color;
+		}
+		if (movableB)
+		{
+			m_simdBodyColors[vc->indexB] |= 1u << color;
+		}
+	}
+
+	// Colors are solved in order, each one as consecutive batches, followed by the overflow.
+	int32 nextLane[b2_simdColorCount];
+	m_simdConstraintCount = 0;
+	for (int32 color = 0; color < b2_simdColorCount; ++color)
+	{
+		nextLane[color] = m_simdConstraintCount * b2_simdWidth;
+		m_simdConstraintCount += (colorCounts[color] + b2_simdWidth - 1) / b2_simdWidth;
+	}
+	int32 nextOverflow = m_simdConstraintCount;
+	m_simdConstraintCount += overflowCount;
+
+	// Only batches with unused lanes need to be cleared.
+	m_simdConstraints = (b2ContactConstraintSIMD*)m_allocator->Allocate(m_simdConstraintCount * sizeof(b2ContactConstraintSIMD));
+	for (int32 i = 0; i <= b2_simdColorCount; ++i)
+	{
+		int32 begin, end;
+		if (i < b2_simdColorCount)
+		{
+			begin = (nextLane[i] + colorCounts[i]) / b2_simdWidth;
+			end = (nextLane[i] + colorCounts[i] + b2_simdWidth - 1) / b2_simdWidth;
+		}
+		else
+		{
+			begin = nextOverflow;
+			end = m_simdConstraintCount;
+		}
+
+		memset(m_simdConstraints + begin, 0, (end - begin) * sizeof(b2ContactConstraintSIMD));
+		for (int32 j = begin; j < end; ++j)
+		{
+			for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+			{
+				m_simdConstraints[j].constraintIndex[lane] = -1;
+			}
+		}
+	}
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		int32 color = m_simdConstraintColors[i];
+		int32 position = color >= 0 ? nextLane[color]++ : b2_simdWidth * nextOverflow++;
+
+		b2ContactConstraintSIMD* sc = m_simdConstraints + position / b2_simdWidth;
+		int32 lane = position % b2_simdWidth;
+		uint32 twoPoints = vc->pointCount == 2 ? 0xffffffffu : 0u;
+		sc->constraintIndex[lane] = i;
+		sc->indexA[lane] = vc->indexA;
+		sc->indexB[lane] = vc->indexB;
+		memcpy(sc->twoPoints + lane, &twoPoints, sizeof(twoPoints));
+		sc->normalX[lane] = vc->normal.x;
+		sc->normalY[lane] = vc->normal.y;
+		sc->friction[lane] = vc->friction;
+		sc->invMassA[lane] = vc->invMassA;
+		sc->invIA[lane] = vc->invIA;
+		sc->invMassB[lane] = vc->invMassB;
+		sc->invIB[lane] = vc->invIB;
+		sc->K11[lane] = vc->K.ex.x;
+		sc->K12[lane] = vc->K.ey.x;
+		sc->K21[lane] = vc->K.ex.y;
+		sc->K22[lane] = vc->K.ey.y;
+		sc->normalMass11[lane] = vc->normalMass.ex.x;
+		sc->normalMass12[lane] = vc->normalMass.ey.x;
+		sc->normalMass21[lane] = vc->normalMass.ex.y;
+		sc->normalMass22[lane] = vc->normalMass.ey.y;
+
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			const b2VelocityConstraintPoint* vcp = vc->points + j;
+			b2ContactConstraintSIMD::Point* point = sc->points + j;
+			point->rAX[lane] = vcp->rA.x;
+			point->rAY[lane] = vcp->rA.y;
+			point->rBX[lane] = vcp->rB.x;
+			point->rBY[lane] = vcp->rB.y;
+			point->normalImpulse[lane] = vcp->normalImpulse;
+			point->tangentImpulse[lane] = vcp->tangentImpulse;
+			point->normalMass[lane] = vcp->normalMass;
+			point->tangentMass[lane] = vcp->tangentMass;
+			point->velocityBias[lane] = vcp->velocityBias;
+		}
+		for (int32 j = vc->pointCount; j < b2_maxManifoldPoints; ++j)
+		{
+			b2ContactConstraintSIMD::Point* point = sc->points + j;
+			point->rAX[lane] = point->rAY[lane] = 0.0f;
+			point->rBX[lane] = point->rBY[lane] = 0.0f;
+			point->normalImpulse[lane] = point->tangentImpulse[lane] = 0.0f;
+			point->normalMass[lane] = point->tangentMass[lane] = 0.0f;
+			point->velocityBias[lane] = 0.0f;
+		}
+	}
+}
+
+void b2ContactSolver::SolveVelocityConstraintsSIMD()
+{
+	const b2FloatW zero = b2SplatW(0.0f);
+
+	for (int32 i = 0; i < m_simdConstraintCount; ++i)
+	{
+		b2ContactConstraintSIMD* sc = m_simdConstraints + i;
+		b2ContactConstraintSIMD::Point* cp1 = sc->points + 0;
+		b2ContactConstraintSIMD::Point* cp2 = sc->points + 1;
+
+		// Gather the body velocities. Unused lanes work on zero velocities and are dropped.
+		float32 vAX[b2_simdWidth], vAY[b2_simdWidth], wA[b2_simdWidth];
+		float32 vBX[b2_simdWidth], vBY[b2_simdWidth], wB[b2_simdWidth];
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			if (sc->constraintIndex[lane] < 0)
+			{
+				vAX[lane] = vAY[lane] = wA[lane] = 0.0f;
+				vBX[lane] = vBY[lane] = wB[lane] = 0.0f;
+				continue;
+			}
+			const b2Velocity& velocityA = m_velocities[sc->indexA[lane]];
+			const b2Velocity& velocityB = m_velocities[sc->indexB[lane]];
+			vAX[lane] = velocityA.v.x;
+			vAY[lane] = velocityA.v.y;
+			wA[lane] = velocityA.w;
+			vBX[lane] = velocityB.v.x;
+			vBY[lane] = velocityB.v.y;
+			wB[lane] = velocityB.w;
+		}
+
+		b2BodyVelocityW a = {b2LoadW(vAX), b2LoadW(vAY), b2LoadW(wA)};
+		b2BodyVelocityW b = {b2LoadW(vBX), b2LoadW(vBY), b2LoadW(wB)};
+		b2FloatW mA = b2LoadW(sc->invMassA), iA = b2LoadW(sc->invIA);
+		b2FloatW mB = b2LoadW(sc->invMassB), iB = b2LoadW(sc->invIB);
+		b2FloatW twoPoints = b2LoadW(sc->twoPoints);
+
+		b2FloatW normalX = b2LoadW(sc->normalX), normalY = b2LoadW(sc->normalY);
+		b2FloatW tangentX = normalY, tangentY = b2NegW(normalX);
+		b2FloatW friction = b2LoadW(sc->friction);
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction. The second point only counts for two point manifolds.
+		for (int32 j = 0; j < b2_maxManifoldPoints; ++j)
+		{
+			b2ContactConstraintSIMD::Point& point = sc->points[j];
+
+			b2FloatW vt = b2RelativeVelocityW(a, b, point, tangentX, tangentY);
+			b2FloatW lambda = b2MulW(b2LoadW(point.tangentMass), b2NegW(vt));
+
+			b2FloatW tangentImpulse = b2LoadW(point.tangentImpulse);
+			b2FloatW maxFriction = b2MulW(friction, b2LoadW(point.normalImpulse));
+			b2FloatW newImpulse = b2MaxW(b2NegW(maxFriction), b2MinW(b2AddW(tangentImpulse, lambda), maxFriction));
+			lambda = b2SubW(newImpulse, tangentImpulse);
+
+			b2BodyVelocityW newA = a, newB = b;
+			b2ApplyImpulseW(&newA, &newB, mA, iA, mB, iB, point, b2MulW(lambda, tangentX), b2MulW(lambda, tangentY));
+
+			if (j == 0)
+			{
+				b2StoreW(point.tangentImpulse, newImpulse);
+				a = newA;
+				b = newB;
+			}
+			else
+			{
+				b2StoreW(point.tangentImpulse, b2SelectW(twoPoints, newImpulse, tangentImpulse));
+				a.vx = b2SelectW(twoPoints, newA.vx, a.vx);
+				a.vy = b2SelectW(twoPoints, newA.vy, a.vy);
+				a.w = b2SelectW(twoPoints, newA.w, a.w);
+				b.vx = b2SelectW(twoPoints, newB.vx, b.vx);
+				b.vy = b2SelectW(twoPoints, newB.vy, b.vy);
+				b.w = b2SelectW(twoPoints, newB.w, b.w);
+			}
+		}
+
+		// Normal constraint of one point manifolds
+		b2BodyVelocityW oneA = a, oneB = b;
+		b2FloatW normalImpulse1 = b2LoadW(cp1->normalImpulse);
+		b2FloatW oneImpulse1;
+		{
+			b2FloatW vn = b2RelativeVelocityW(a, b, *cp1, normalX, normalY);
+			b2FloatW lambda = b2MulW(b2NegW(b2LoadW(cp1->normalMass)), b2SubW(vn, b2LoadW(cp1->velocityBias)));
+
+			oneImpulse1 = b2MaxW(b2AddW(normalImpulse1, lambda), zero);
+			lambda = b2SubW(oneImpulse1, normalImpulse1);
+
+			b2ApplyImpulseW(&oneA, &oneB, mA, iA, mB, iB, *cp1, b2MulW(lambda, normalX), b2MulW(lambda, normalY));
+		}
+
+		// Block solver of two point manifolds, all four cases of
+		// b2ContactSolver::SolveVelocityConstraints are evaluated and the first valid one is used.
+		b2BodyVelocityW twoA = a, twoB = b;
+		b2FloatW normalImpulse2 = b2LoadW(cp2->normalImpulse);
+		b2FloatW twoImpulse1, twoImpulse2;
+		{
+			b2FloatW aX = normalImpulse1, aY = normalImpulse2;
+
+			b2FloatW vn1 = b2RelativeVelocityW(a, b, *cp1, normalX, normalY);
+			b2FloatW vn2 = b2RelativeVelocityW(a, b, *cp2, normalX, normalY);
+
+			b2FloatW K11 = b2LoadW(sc->K11), K12 = b2LoadW(sc->K12);
+			b2FloatW K21 = b2LoadW(sc->K21), K22 = b2LoadW(sc->K22);
+			b2FloatW bX = b2SubW(b2SubW(vn1, b2LoadW(cp1->velocityBias)), b2AddW(b2MulW(K11, aX), b2MulW(K12, aY)));
+			b2FloatW bY = b2SubW(b2SubW(vn2, b2LoadW(cp2->velocityBias)), b2AddW(b2MulW(K21, aX), b2MulW(K22, aY)));
+
+			// Case 1: vn = 0
+			b2FloatW x1X = b2NegW(b2AddW(b2MulW(b2LoadW(sc->normalMass11), bX), b2MulW(b2LoadW(sc->normalMass12), bY)));
+			b2FloatW x1Y = b2NegW(b2AddW(b2MulW(b2LoadW(sc->normalMass21), bX), b2MulW(b2LoadW(sc->normalMass22), bY)));
+			b2FloatW valid1 = b2AndW(b2GreaterEqualW(x1X, zero), b2GreaterEqualW(x1Y, zero));
+
+			// Case 2: vn1 = 0 and x2 = 0
+			b2FloatW x2X = b2MulW(b2NegW(b2LoadW(cp1->normalMass)), bX);
+			b2FloatW valid2 = b2AndW(b2GreaterEqualW(x2X, zero), b2GreaterEqualW(b2AddW(b2MulW(K21, x2X), bY), zero));
+
+			// Case 3: vn2 = 0 and x1 = 0
+			b2FloatW x3Y = b2MulW(b2NegW(b2LoadW(cp2->normalMass)), bY);
+			b2FloatW valid3 = b2AndW(b2GreaterEqualW(x3Y, zero), b2GreaterEqualW(b2AddW(b2MulW(K12, x3Y), bX), zero));
+
+			// Case 4: x1 = 0 and x2 = 0
+			b2FloatW valid4 = b2AndW(b2GreaterEqualW(bX, zero), b2GreaterEqualW(bY, zero));
+
+			// Pick the first valid case, from the last to the first. No solution keeps the
+			// impulses and velocities.
+			b2FloatW xX = b2SelectW(valid4, zero, aX);
+			b2FloatW xY = b2SelectW(valid4, zero, aY);
+			xX = b2SelectW(valid3, zero, xX);
+			xY = b2SelectW(valid3, x3Y, xY);
+			xX = b2SelectW(valid2, x2X, xX);
+			xY = b2SelectW(valid2, zero, xY);
+			xX = b2SelectW(valid1, x1X, xX);
+			xY = b2SelectW(valid1, x1Y, xY);
+			b2FloatW anyValid = b2OrW(b2OrW(valid1, valid2), b2OrW(valid3, valid4));
+
+			// Apply the incremental impulse
+			b2FloatW dX = b2SubW(xX, aX), dY = b2SubW(xY, aY);
+			b2FloatW P1X = b2MulW(dX, normalX), P1Y = b2MulW(dX, normalY);
+			b2FloatW P2X = b2MulW(dY, normalX), P2Y = b2MulW(dY, normalY);
+
+			b2BodyVelocityW newA, newB;
+			newA.vx = b2SubW(a.vx, b2MulW(mA, b2AddW(P1X, P2X)));
+			newA.vy = b2SubW(a.vy, b2MulW(mA, b2AddW(P1Y, P2Y)));
+			newA.w = b2SubW(a.w, b2MulW(iA, b2AddW(b2CrossW(b2LoadW(cp1->rAX), b2LoadW(cp1->rAY), P1X, P1Y),
+												   b2CrossW(b2LoadW(cp2->rAX), b2LoadW(cp2->rAY), P2X, P2Y))));
+			newB.vx = b2AddW(b.vx, b2MulW(mB, b2AddW(P1X, P2X)));
+			newB.vy = b2AddW(b.vy, b2MulW(mB, b2AddW(P1Y, P2Y)));
+			newB.w = b2AddW(b.w, b2MulW(iB, b2AddW(b2CrossW(b2LoadW(cp1->rBX), b2LoadW(cp1->rBY), P1X, P1Y),
+												   b2CrossW(b2LoadW(cp2->rBX), b2LoadW(cp2->rBY), P2X, P2Y))));
+
+			twoA.vx = b2SelectW(anyValid, newA.vx, a.vx);
+			twoA.vy = b2SelectW(anyValid, newA.vy, a.vy);
+			twoA.w = b2SelectW(anyValid, newA.w, a.w);
+			twoB.vx = b2SelectW(anyValid, newB.vx, b.vx);
+			twoB.vy = b2SelectW(anyValid, newB.vy, b.vy);
+			twoB.w = b2SelectW(anyValid, newB.w, b.w);
+			twoImpulse1 = xX;
+			twoImpulse2 = xY;
+		}
+
+		b2StoreW(cp1->normalImpulse, b2SelectW(twoPoints, twoImpulse1, oneImpulse1));
+		b2StoreW(cp2->normalImpulse, b2SelectW(twoPoints, twoImpulse2, normalImpulse2));
+		b2StoreW(vAX, b2SelectW(twoPoints, twoA.vx, oneA.vx));
+		b2StoreW(vAY, b2SelectW(twoPoints, twoA.vy, oneA.vy));
+		b2StoreW(wA, b2SelectW(twoPoints, twoA.w, oneA.w));
+		b2StoreW(vBX, b2SelectW(twoPoints, twoB.vx, oneB.vx));
+		b2StoreW(vBY, b2SelectW(twoPoints, twoB.vy, oneB.vy));
+		b2StoreW(wB, b2SelectW(twoPoints, twoB.w, oneB.w));
+
+		// Scatter in lane order. Only bodies without mass can be shared by lanes and their
+		// velocities do not change.
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			if (sc->constraintIndex[lane] < 0)
+			{
+				continue;
+			}
+			b2Velocity& velocityA = m_velocities[sc->indexA[lane]];
+			b2Velocity& velocityB = m_velocities[sc->indexB[lane]];
+			velocityA.v.Set(vAX[lane], vAY[lane]);
+			velocityA.w = wA[lane];
+			velocityB.v.Set(vBX[lane], vBY[lane]);
+			velocityB.w = wB[lane];
+		}
+	}
+}
+
+void b2ContactSolver::StoreImpulsesSIMD()
+{
+	for (int32 i = 0; i < m_simdConstraintCount; ++i)
+	{
+		const b2ContactConstraintSIMD* sc = m_simdConstraints + i;
+		for (int32 lane = 0; lane < b2_simdWidth; ++lane)
+		{
+			if (sc->constraintIndex[lane] < 0)
+			{
+				continue;
+			}
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + sc->constraintIndex[lane];
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				vc->points[j].normalImpulse = sc->points[j].normalImpulse[lane];
+				vc->points[j].tangentImpulse = sc->points[j].tangentImpulse[lane];
+			}
+		}
+	}
+}
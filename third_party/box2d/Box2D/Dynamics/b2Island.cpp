@@ -150,7 +150,8 @@ b2Island::b2Island(
 	int32 contactCapacity,
 	int32 jointCapacity,
 	b2StackAllocator* allocator,
-	b2ContactListener* listener)
+	b2ContactListener* listener,
+	int32 staticSlotCount)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
@@ -158,6 +159,7 @@ b2Island::b2Island(
 	m_bodyCount = 0;
 	m_contactCount = 0;
 	m_jointCount = 0;
+	m_staticSlotCount = staticSlotCount;
 
 	m_allocator = allocator;
 	m_listener = listener;
@@ -186,6 +188,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	float32 h = step.dt;
 
+	// The state of m_bodies[i] is stored behind the static body slots.
+	b2Position* positions = m_positions + m_staticSlotCount;
+	b2Velocity* velocities = m_velocities + m_staticSlotCount;
+
 	// Integrate velocities and apply damping. Initialize the body state.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
@@ -217,10 +223,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			w *= b2Clamp(1.0f - h * b->m_angularDamping, 0.0f, 1.0f);
 		}
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		positions[i].c = c;
+		positions[i].a = a;
+		velocities[i].v = v;
+		velocities[i].w = w;
 	}
 
 	timer.Reset();
@@ -274,10 +280,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	// Integrate positions
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
+		b2Vec2 c = positions[i].c;
+		float32 a = positions[i].a;
+		b2Vec2 v = velocities[i].v;
+		float32 w = velocities[i].w;
 
 		// Check for large velocities
 		b2Vec2 translation = h * v;
@@ -298,10 +304,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		c += h * v;
 		a += h * w;
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		positions[i].c = c;
+		positions[i].a = a;
+		velocities[i].v = v;
+		velocities[i].w = w;
 	}
 
 	// Solve position constraints
@@ -330,10 +336,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
+		body->m_sweep.c = positions[i].c;
+		body->m_sweep.a = positions[i].a;
+		body->m_linearVelocity = velocities[i].v;
+		body->m_angularVelocity = velocities[i].w;
 		body->SynchronizeTransform();
 	}
 
@@ -35,7 +35,7 @@ class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactListener* listener, int32 staticSlotCount = 0);
 	~b2Island();
 
 	void Clear()
@@ -51,12 +51,25 @@ public:
 
 	void Add(b2Body* body)
 	{
-		b2Assert(m_bodyCount < m_bodyCapacity);
-		body->m_islandIndex = m_bodyCount;
+		b2Assert(m_staticSlotCount + m_bodyCount < m_bodyCapacity);
+		body->m_islandIndex = m_staticSlotCount + m_bodyCount;
 		m_bodies[m_bodyCount] = body;
 		++m_bodyCount;
 	}
 
+	// Islands solved concurrently share static bodies. These keep an index below
+	// m_staticSlotCount that is the same for all islands and are not added to m_bodies.
+	void AddStatic(b2Body* body)
+	{
+		b2Assert(body->GetType() == b2_staticBody);
+		b2Assert(0 <= body->m_islandIndex && body->m_islandIndex < m_staticSlotCount);
+		int32 index = body->m_islandIndex;
+		m_positions[index].c = body->m_sweep.c;
+		m_positions[index].a = body->m_sweep.a;
+		m_velocities[index].v = body->m_linearVelocity;
+		m_velocities[index].w = body->m_angularVelocity;
+	}
+
 	void Add(b2Contact* contact)
 	{
 		b2Assert(m_contactCount < m_contactCapacity);
@@ -84,6 +97,7 @@ public:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
+	int32 m_staticSlotCount;
 
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
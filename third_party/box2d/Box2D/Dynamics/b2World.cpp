@@ -31,6 +31,7 @@
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2ThreadPool.h>
 #include <Box2D/Common/b2Timer.h>
 #include <new>
 
@@ -46,6 +47,7 @@ b2World::b2World(const b2Vec2& gravity)
 	m_jointCount = 0;
 
 	m_warmStarting = true;
+	m_simdContactSolver = false;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
@@ -60,6 +62,9 @@ b2World::b2World(const b2Vec2& gravity)
 
 	m_contactManager.m_allocator = &m_blockAllocator;
 
+	m_threadPool = NULL;
+	m_threadStackAllocators = NULL;
+
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
 
@@ -82,6 +87,9 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	delete m_threadPool;
+	delete [] m_threadStackAllocators;
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -382,6 +390,32 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+// emscripten - island parallel solver
+void b2World::SetThreadCount(int32 count)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked() || count == GetThreadCount())
+	{
+		return;
+	}
+
+	delete m_threadPool;
+	delete [] m_threadStackAllocators;
+	m_threadPool = NULL;
+	m_threadStackAllocators = NULL;
+
+	if (count > 1)
+	{
+		m_threadPool = new b2ThreadPool(count);
+		m_threadStackAllocators = new b2StackAllocator[count - 1];
+	}
+}
+
+int32 b2World::GetThreadCount() const
+{
+	return m_threadPool ? m_threadPool->GetThreadCount() : 1;
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -389,13 +423,6 @@ void b2World::Solve(const b2TimeStep& step)
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
-
 	// Clear all the island flags.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
@@ -411,6 +438,50 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 
 	// Build and simulate all awake islands.
+	if (m_threadPool)
+	{
+		SolveIslandsParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
+
+	{
+		b2Timer timer;
+		// Synchronize fixtures, check for out of range bodies.
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			// If a body was not in an island then it did not move.
+			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			{
+				continue;
+			}
+
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			// Update fixtures (for broad-phase).
+			b->SynchronizeFixtures();
+		}
+
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+void b2World::SolveIslands(const b2TimeStep& step)
+{
+	// Size the island for the worst case.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					m_contactManager.m_contactListener);
+
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
@@ -546,31 +617,267 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 
 	m_stackAllocator.Free(stack);
+}
+
+// The bodies, contacts, joints and referenced static bodies of an island are stored as ranges
+// of the arrays collected by SolveIslandsParallel.
+struct b2IslandRange
+{
+	int32 bodyStart, bodyCount;
+	int32 contactStart, contactCount;
+	int32 jointStart, jointCount;
+	int32 staticStart, staticCount;
+};
 
+class b2SolveIslandTask : public b2ThreadTask
+{
+public:
+	void Execute(int32 index, int32 threadIndex)
 	{
-		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		const b2IslandRange& range = ranges[index];
+		b2StackAllocator* allocator = threadIndex == 0 ? stackAllocator : threadStackAllocators + (threadIndex - 1);
+
+		b2Island island(staticSlotCount + range.bodyCount,
+						range.contactCount,
+						range.jointCount,
+						allocator,
+						listener,
+						staticSlotCount);
+
+		for (int32 i = 0; i < range.staticCount; ++i)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			island.AddStatic(statics[range.staticStart + i]);
+		}
+		for (int32 i = 0; i < range.bodyCount; ++i)
+		{
+			island.Add(bodies[range.bodyStart + i]);
+		}
+		for (int32 i = 0; i < range.contactCount; ++i)
+		{
+			island.Add(contacts[range.contactStart + i]);
+		}
+		for (int32 i = 0; i < range.jointCount; ++i)
+		{
+			island.Add(joints[range.jointStart + i]);
+		}
+
+		island.Solve(profiles + index, *step, gravity, allowSleep);
+	}
+
+	const b2IslandRange* ranges;
+	b2Body** bodies;
+	b2Body** statics;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2Profile* profiles;
+
+	int32 staticSlotCount;
+	b2StackAllocator* stackAllocator;
+	b2StackAllocator* threadStackAllocators;
+	b2ContactListener* listener;
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+};
+
+// Same as SolveIslands, but all islands are collected first in the same order and then solved
+// concurrently. Static bodies may be shared between islands, so they get an island index below
+// the static slot count that is valid in every island and are never written to by the solver.
+void b2World::SolveIslandsParallel(const b2TimeStep& step)
+{
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->GetType() == b2_staticBody)
+		{
+			b->m_islandIndex = -1;
+		}
+	}
+
+	// A static body is referenced at most once per contact or joint.
+	int32 contactCount = m_contactManager.m_contactCount;
+	int32 staticCapacity = contactCount + m_jointCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2Body*));
+	b2IslandRange* ranges = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2Body*));
+	b2Body** statics = (b2Body**)m_stackAllocator.Allocate(staticCapacity * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(contactCount * sizeof(b2Contact*));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+
+	int32 islandCount = 0;
+	int32 bodyCount = 0;
+	int32 staticCount = 0;
+	int32 islandContactCount = 0;
+	int32 jointCount = 0;
+	int32 staticSlotCount = 0;
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2IslandRange& range = ranges[islandCount++];
+		range.bodyStart = bodyCount;
+		range.contactStart = islandContactCount;
+		range.jointStart = jointCount;
+		range.staticStart = staticCount;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsActive() == true);
+
+			// Make sure the body is awake.
+			b->SetAwake(true);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
 			{
+				if (b->m_islandIndex == -1)
+				{
+					b->m_islandIndex = staticSlotCount++;
+				}
+				b2Assert(staticCount < staticCapacity);
+				statics[staticCount++] = b;
 				continue;
 			}
 
-			if (b->GetType() == b2_staticBody)
+			bodies[bodyCount++] = b;
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 			{
-				continue;
+				b2Contact* contact = ce->contact;
+
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				contacts[islandContactCount++] = contact;
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+
+				// Was the other body already added to this island?
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < m_bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
 			}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to inactive bodies.
+				if (other->IsActive() == false)
+				{
+					continue;
+				}
+
+				joints[jointCount++] = je->joint;
+				je->joint->m_islandFlag = true;
+
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < m_bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
 		}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+		range.bodyCount = bodyCount - range.bodyStart;
+		range.contactCount = islandContactCount - range.contactStart;
+		range.jointCount = jointCount - range.jointStart;
+		range.staticCount = staticCount - range.staticStart;
+
+		// Allow static bodies to participate in other islands.
+		for (int32 i = range.staticStart; i < staticCount; ++i)
+		{
+			statics[i]->m_flags &= ~b2Body::e_islandFlag;
+		}
+	}
+
+	b2Profile* profiles = (b2Profile*)m_stackAllocator.Allocate(islandCount * sizeof(b2Profile));
+
+	b2SolveIslandTask task;
+	task.ranges = ranges;
+	task.bodies = bodies;
+	task.statics = statics;
+	task.contacts = contacts;
+	task.joints = joints;
+	task.profiles = profiles;
+	task.staticSlotCount = staticSlotCount;
+	task.stackAllocator = &m_stackAllocator;
+	task.threadStackAllocators = m_threadStackAllocators;
+	task.listener = m_contactManager.m_contactListener;
+	task.step = &step;
+	task.gravity = m_gravity;
+	task.allowSleep = m_allowSleep;
+	m_threadPool->Run(&task, islandCount);
+
+	// Sum up in island order, so the profile does not depend on the scheduling either.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
 	}
+
+	m_stackAllocator.Free(profiles);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(statics);
+	m_stackAllocator.Free(bodies);
+	m_stackAllocator.Free(ranges);
+	m_stackAllocator.Free(stack);
 }
 
 // Find TOI contacts and solve them.
@@ -860,6 +1167,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.simdContactSolver = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -923,6 +1231,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.simdContactSolver = m_simdContactSolver;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
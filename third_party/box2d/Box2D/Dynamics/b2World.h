@@ -34,6 +34,7 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2ThreadPool;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -149,6 +150,19 @@ public:
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
 
+	// emscripten - SIMD contact solver
+	/// Enable/disable the SIMD contact solver. It solves batches of contacts that share no
+	/// body with mass together, so the results drift from the default solver but stay
+	/// deterministic.
+	void SetSIMDContactSolver(bool flag) { m_simdContactSolver = flag; }
+	bool GetSIMDContactSolver() const { return m_simdContactSolver; }
+
+	// emscripten - batched broad-phase queries
+	/// Enable/disable batched tree queries for the proxies that moved in a time step. The
+	/// broad-phase finds the same pairs either way.
+	void SetBatchedBroadPhaseQueries(bool flag) { m_contactManager.m_broadPhase.SetBatchedQueries(flag); }
+	bool GetBatchedBroadPhaseQueries() const { return m_contactManager.m_broadPhase.GetBatchedQueries(); }
+
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 	bool GetContinuousPhysics() const { return m_continuousPhysics; }
@@ -157,6 +171,14 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	// emscripten - island parallel solver
+	/// Solve the islands of a time step on this many threads, 1 solves them on the calling
+	/// thread. The results do not depend on the thread count. With more than one thread the
+	/// contact listener's PostSolve is called from worker threads.
+	/// @warning this should be called outside of a time step.
+	void SetThreadCount(int32 count);
+	int32 GetThreadCount() const;
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -220,6 +242,8 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveIslands(const b2TimeStep& step);
+	void SolveIslandsParallel(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawJoint(b2Joint* joint);
@@ -228,6 +252,10 @@ private:
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
+	// One stack allocator per worker thread, the calling thread uses m_stackAllocator.
+	b2ThreadPool* m_threadPool;
+	b2StackAllocator* m_threadStackAllocators;
+
 	int32 m_flags;
 
 	b2ContactManager m_contactManager;
@@ -250,6 +278,7 @@ private:
 
 	// These are for debugging the solver.
 	bool m_warmStarting;
+	bool m_simdContactSolver;
 	bool m_continuousPhysics;
 	bool m_subStepping;
 
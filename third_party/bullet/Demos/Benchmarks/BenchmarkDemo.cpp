@@ -26,9 +26,19 @@ subject to the following restrictions:
 ///btBulletDynamicsCommon.h is the main Bullet include file, contains most common include files.
 #include "btBulletDynamicsCommon.h"
 #include <stdio.h> //printf debugging
+#include <string.h>
+#if defined (__unix__) || defined (__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define USE_MMAP_BVH_CACHE
+#endif
 #include "Taru.mdl"
 #include "landscape.mdl"
 #include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btBatchedRaycaster.h"
+#include "wasm_perf.h"
 #ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
 #include "BulletMultiThreaded/SpuGatheringCollisionDispatcher.h"
 #include "BulletMultiThreaded/SequentialThreadSupport.h"
@@ -46,9 +56,37 @@ subject to the following restrictions:
 #endif
 #include "BulletMultiThreaded/SpuGatheringCollisionDispatcher.h"
 #include "BulletMultiThreaded/btParallelConstraintSolver.h"
+#include "BulletMultiThreaded/btParallelBatchRaycaster.h"
+#endif
+
+///Number of collision and solver threads, 0 uses the sequential dispatcher and solver.
+int gParallelThreads = 0;
 
+bool gBatchRaycast = false;
 
+BenchmarkBroadphase gBroadphase = BENCHMARK_BROADPHASE_AXIS_SWEEP;
 
+int gBroadphaseObjects = 1000;
+
+int gBroadphaseJump = 0;
+
+const char* gBvhCachePath = 0;
+
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+btThreadSupportInterface* createCollisionThreadSupport(int maxNumThreads)
+{
+#ifdef _WIN32
+	Win32ThreadSupport* threadSupport = new Win32ThreadSupport(Win32ThreadSupport::Win32ThreadConstructionInfo("collision",processCollisionTask,createCollisionLocalStoreMemory,maxNumThreads));
+#elif defined (USE_PTHREADS)
+	PosixThreadSupport::ThreadConstructionInfo collisionConstructionInfo("collision", processCollisionTask,
+																		 createCollisionLocalStoreMemory, maxNumThreads);
+	PosixThreadSupport* threadSupport = new PosixThreadSupport(collisionConstructionInfo);
+#else
+	SequentialThreadSupport::SequentialThreadConstructionInfo sci("spuCD",processCollisionTask,createCollisionLocalStoreMemory);
+	SequentialThreadSupport* threadSupport = new SequentialThreadSupport(sci);
+#endif
+	return threadSupport;
+}
 
 btThreadSupportInterface* createSolverThreadSupport(int maxNumThreads)
 {
@@ -79,6 +117,21 @@ btThreadSupportInterface* createSolverThreadSupport(int maxNumThreads)
 
 	return threadSupport;
 }
+
+btThreadSupportInterface* createRaycastThreadSupport(int maxNumThreads)
+{
+#ifdef _WIN32
+	Win32ThreadSupport* threadSupport = new Win32ThreadSupport(Win32ThreadSupport::Win32ThreadConstructionInfo("raycast",BatchRaycastThreadFunc,BatchRaycastlsMemoryFunc,maxNumThreads));
+#elif defined (USE_PTHREADS)
+	PosixThreadSupport::ThreadConstructionInfo raycastConstructionInfo("raycast", BatchRaycastThreadFunc,
+																	   BatchRaycastlsMemoryFunc, maxNumThreads);
+	PosixThreadSupport* threadSupport = new PosixThreadSupport(raycastConstructionInfo);
+#else
+	SequentialThreadSupport::SequentialThreadConstructionInfo sci("raycast",BatchRaycastThreadFunc,BatchRaycastlsMemoryFunc);
+	SequentialThreadSupport* threadSupport = new SequentialThreadSupport(sci);
+#endif
+	return threadSupport;
+}
 #endif
 
 class btRaycastBar2
@@ -91,6 +144,9 @@ public:
 	btVector3 normal[NUMRAYS];
 
 	int frame_counter;
+	int num_casts;
+	///FNV-1a hash of all hit points, to compare the results of the single and batched ray casts
+	unsigned int hit_hash;
 	int ms;
 	int sum_ms;
 	int sum_ms_samples;
@@ -109,6 +165,8 @@ public:
 
 	btRaycastBar2 ()
 	{
+		num_casts = 0;
+		hit_hash = 2166136261u;
 		ms = 0;
 		max_ms = 0;
 		min_ms = 9999;
@@ -121,6 +179,8 @@ public:
 	btRaycastBar2 (btScalar ray_length, btScalar z,btScalar max_y)
 	{
 		frame_counter = 0;
+		num_casts = 0;
+		hit_hash = 2166136261u;
 		ms = 0;
 		max_ms = 0;
 		min_ms = 9999;
@@ -164,46 +224,62 @@ public:
 			sign = -1.0;
 	}
 
-	void cast (btCollisionWorld* cw)
+	///closest hits with one rayTest per ray, or all rays at once with the batchRaycaster if there is one
+	void cast (btCollisionWorld* cw, btBatchedRaycaster* batchRaycaster)
 	{
 #ifdef USE_BT_CLOCK
 		frame_timer.reset ();
 #endif //USE_BT_CLOCK
 
-#ifdef BATCH_RAYCASTER
-		if (!gBatchRaycaster)
-			return;
-
-		gBatchRaycaster->clearRays ();
-		for (int i = 0; i < NUMRAYS; i++)
+		if (batchRaycaster)
 		{
-			gBatchRaycaster->addRay (source[i], dest[i]);
-		}
-		gBatchRaycaster->performBatchRaycast ();
-		for (int i = 0; i < gBatchRaycaster->getNumRays (); i++)
+			batchRaycaster->clearRays ();
+			for (int i = 0; i < NUMRAYS; i++)
+			{
+				batchRaycaster->addRay (source[i], dest[i]);
+			}
+			batchRaycaster->performBatchRaycast ();
+			for (int i = 0; i < batchRaycaster->getNumRays (); i++)
+			{
+				const btBatchedRayResult& out = (*batchRaycaster)[i];
+				if (out.hasHit ())
+				{
+					hit[i] = out.m_hitPointWorld;
+					normal[i] = out.m_hitNormalWorld;
+					normal[i].normalize ();
+				} else {
+					hit[i] = dest[i];
+					normal[i] = btVector3(1.0, 0.0, 0.0);
+				}
+			}
+		} else
 		{
-				const SpuRaycastTaskWorkUnitOut& out = (*gBatchRaycaster)[i];
-				hit[i].setInterpolate3(source[i],dest[i],out.hitFraction);
-				normal[i] = out.hitNormal;
-				normal[i].normalize ();
+			for (int i = 0; i < NUMRAYS; i++)
+			{
+				btCollisionWorld::ClosestRayResultCallback cb(source[i], dest[i]);
+
+				cw->rayTest (source[i], dest[i], cb);
+				if (cb.hasHit ())
+				{
+					hit[i] = cb.m_hitPointWorld;
+					normal[i] = cb.m_hitNormalWorld;
+					normal[i].normalize ();
+				} else {
+					hit[i] = dest[i];
+					normal[i] = btVector3(1.0, 0.0, 0.0);
+				}
+
+			}
 		}
-#else
 		for (int i = 0; i < NUMRAYS; i++)
 		{
-			btCollisionWorld::ClosestRayResultCallback cb(source[i], dest[i]);
-			
-			cw->rayTest (source[i], dest[i], cb);
-			if (cb.hasHit ())
+			const unsigned char* bytes = (const unsigned char*)&hit[i];
+			for (int b = 0; b < int(3*sizeof(btScalar)); b++)
 			{
-				hit[i] = cb.m_hitPointWorld;
-				normal[i] = cb.m_hitNormalWorld;
-				normal[i].normalize ();
-			} else {
-				hit[i] = dest[i];
-				normal[i] = btVector3(1.0, 0.0, 0.0);
+				hit_hash = (hit_hash ^ bytes[b]) * 16777619u;
 			}
-
 		}
+		num_casts++;
 #ifdef USE_BT_CLOCK
 		ms += frame_timer.getTimeMilliseconds ();
 #endif //USE_BT_CLOCK
@@ -219,7 +295,6 @@ public:
 			ms = 0;
 			frame_counter = 0;
 		}
-#endif
 	}
 
 	void draw ()
@@ -271,7 +346,13 @@ void BenchmarkDemo::clientMoveAndDisplay()
 	//float ms = getDeltaTimeMicroseconds();
 	
 	///step the simulation
-	if (m_dynamicsWorld)
+	if (m_benchmark==8)
+	{
+		///the broadphase demo only updates the broadphase, without narrowphase and solver
+		if (m_dynamicsWorld)
+			stepTest8();
+	}
+	else if (m_dynamicsWorld)
 	{
 		m_dynamicsWorld->stepSimulation(btScalar(1./60.));
 		//optional but useful: debug drawing
@@ -328,54 +409,71 @@ void	BenchmarkDemo::initPhysics()
 	cci.m_defaultMaxPersistentManifoldPoolSize = 32768;
 	m_collisionConfiguration = new btDefaultCollisionConfiguration(cci);
 
-	///use the default collision dispatcher. For parallel processing you can use a diffent dispatcher (see Extras/BulletMultiThreaded)
-	m_dispatcher = new	btCollisionDispatcher(m_collisionConfiguration);
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+	if (gParallelThreads > 0)
+	{
+		///one outstanding collision task per thread
+		m_collisionThreadSupport = createCollisionThreadSupport(gParallelThreads);
+		m_dispatcher = new	SpuGatheringCollisionDispatcher(m_collisionThreadSupport,gParallelThreads,m_collisionConfiguration);
+	}
+	else
+#endif //USE_PARALLEL_DISPATCHER_BENCHMARK
+	{
+		///use the default collision dispatcher. For parallel processing you can use a diffent dispatcher (see Extras/BulletMultiThreaded)
+		m_dispatcher = new	btCollisionDispatcher(m_collisionConfiguration);
+	}
 	
 	m_dispatcher->setDispatcherFlags(btCollisionDispatcher::CD_DISABLE_CONTACTPOOL_DYNAMIC_ALLOCATION);
 
-#if USE_PARALLEL_DISPATCHER_BENCHMARK
-
-	int maxNumOutstandingTasks = 4;
-#ifdef _WIN32
-	Win32ThreadSupport* threadSupportCollision = new Win32ThreadSupport(Win32ThreadSupport::Win32ThreadConstructionInfo(	"collision",processCollisionTask,	createCollisionLocalStoreMemory,maxNumOutstandingTasks));
-#elif defined (USE_PTHREADS)
-        PosixThreadSupport::ThreadConstructionInfo collisionConstructionInfo( "collision",processCollisionTask,       createCollisionLocalStoreMemory,maxNumOutstandingTasks);
-	PosixThreadSupport* threadSupportCollision = new PosixThreadSupport(collisionConstructionInfo);
-#endif
-	//SequentialThreadSupport::SequentialThreadConstructionInfo sci("spuCD",	processCollisionTask,	createCollisionLocalStoreMemory);
-	//SequentialThreadSupport* seq = new SequentialThreadSupport(sci);
-	m_dispatcher = new	SpuGatheringCollisionDispatcher(threadSupportCollision,1,m_collisionConfiguration);
-#endif
-
 
 	///the maximum size of the collision world. Make sure objects stay within these boundaries
 	///Don't make the world AABB size too large, it will harm simulation quality and performance
 	btVector3 worldAabbMin(-1000,-1000,-1000);
 	btVector3 worldAabbMax(1000,1000,1000);
 	
-	btHashedOverlappingPairCache* pairCache = new btHashedOverlappingPairCache();
-	m_overlappingPairCache = new btAxisSweep3(worldAabbMin,worldAabbMax,3500,pairCache);
-//	m_overlappingPairCache = new btSimpleBroadphase();
-//	m_overlappingPairCache = new btDbvtBroadphase();
+	///the broadphase demo needs a proxy per object, the other demos stay below 3500
+	int maxProxies = 3500;
+	if (m_benchmark==8 && gBroadphaseObjects+16 > maxProxies)
+		maxProxies = gBroadphaseObjects+16;
+
+	m_pairCache = new btHashedOverlappingPairCache();
+	switch (gBroadphase)
+	{
+	case BENCHMARK_BROADPHASE_DBVT:
+		m_overlappingPairCache = new btDbvtBroadphase(m_pairCache);
+		break;
+	case BENCHMARK_BROADPHASE_SIMPLE:
+		m_overlappingPairCache = new btSimpleBroadphase(maxProxies,m_pairCache);
+		break;
+	default:
+		///btAxisSweep3 uses 16 bit handles, one of which is reserved as sentinel
+		if (maxProxies < 32767)
+			m_overlappingPairCache = new btAxisSweep3(worldAabbMin,worldAabbMax,(unsigned short)maxProxies,m_pairCache);
+		else
+			m_overlappingPairCache = new bt32BitAxisSweep3(worldAabbMin,worldAabbMax,maxProxies,m_pairCache);
+	}
 	
 
 	///the default constraint solver. For parallel processing you can use a different solver (see Extras/BulletMultiThreaded)
 #ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
-
-	btThreadSupportInterface* thread = createSolverThreadSupport(4);
-	btConstraintSolver* sol = new btParallelConstraintSolver(thread);
-#else
-	btSequentialImpulseConstraintSolver* sol = new btSequentialImpulseConstraintSolver;
+	if (gParallelThreads > 0)
+	{
+		m_solverThreadSupport = createSolverThreadSupport(gParallelThreads);
+		m_solver = new btParallelConstraintSolver(m_solverThreadSupport);
+	}
+	else
 #endif //USE_PARALLEL_DISPATCHER_BENCHMARK
-	
-	
-	m_solver = sol;
+	{
+		m_solver = new btSequentialImpulseConstraintSolver;
+	}
 
 	btDiscreteDynamicsWorld* dynamicsWorld;
 	m_dynamicsWorld = dynamicsWorld = new btDiscreteDynamicsWorld(m_dispatcher,m_overlappingPairCache,m_solver,m_collisionConfiguration);
 	
 #ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
-	dynamicsWorld->getSimulationIslandManager()->setSplitIslands(false);
+	///the parallel solver solves all islands in one batch
+	if (gParallelThreads > 0)
+		dynamicsWorld->getSimulationIslandManager()->setSplitIslands(false);
 #endif //USE_PARALLEL_DISPATCHER_BENCHMARK
 
 	///the following 3 lines increase the performance dramatically, with a little bit of loss of quality
@@ -456,6 +554,11 @@ void	BenchmarkDemo::initPhysics()
 			createTest7();
 			break;
 		}
+		case 8:
+		{
+			createTest8();
+			break;
+		}
 
 
 	default:
@@ -1066,28 +1169,262 @@ unsigned short  *LandscapeIdx[] = {
 	Landscape08Idx,
 };
 
+#define LANDSCAPE_PARTS 8
+
+static btTriangleIndexVertexArray*	createLandscapeMesh(int i)
+{
+	btTriangleIndexVertexArray* meshInterface = new btTriangleIndexVertexArray();
+	btIndexedMesh part;
+
+	part.m_vertexBase = (const unsigned char*)LandscapeVtx[i];
+	part.m_vertexStride = sizeof(btScalar) * 3;
+	part.m_numVertices = LandscapeVtxCount[i];
+	part.m_triangleIndexBase = (const unsigned char*)LandscapeIdx[i];
+	part.m_triangleIndexStride = sizeof( short) * 3;
+	part.m_numTriangles = LandscapeIdxCount[i]/3;
+	part.m_indexType = PHY_SHORT;
+
+	meshInterface->addIndexedMesh(part,PHY_SHORT);
+	return meshInterface;
+}
+
+///FNV-1a hash of the landscape vertices and indices, so that a cache of an older mesh is rebuilt
+static unsigned int	landscapeHash()
+{
+	static unsigned int cachedHash = 0;
+	if (cachedHash)
+		return cachedHash;
+	unsigned int hash = 2166136261u;
+	for (int i=0;i<LANDSCAPE_PARTS;i++)
+	{
+		const unsigned char* vertices = (const unsigned char*)LandscapeVtx[i];
+		for (unsigned int j=0;j<LandscapeVtxCount[i]*3*sizeof(btScalar);j++)
+			hash = (hash ^ vertices[j]) * 16777619u;
+		const unsigned char* indices = (const unsigned char*)LandscapeIdx[i];
+		for (unsigned int j=0;j<LandscapeIdxCount[i]*sizeof(unsigned short);j++)
+			hash = (hash ^ indices[j]) * 16777619u;
+	}
+	cachedHash = hash;
+	return hash;
+}
+
+///The serialized btQuantizedBvh of each landscape part follows the header at a 16 byte aligned offset.
+///The local AABB of each part is stored as well, so that loading does not walk all triangles for it.
+///The in place format stores the btQuantizedBvh object itself, so a cache is only valid for the same
+///pointer size, scalar type and btQuantizedBvh layout as the binary that wrote it.
+struct LandscapeBvhCacheHeader
+{
+	char	m_magic[8];
+	unsigned int	m_pointerSize;
+	unsigned int	m_scalarSize;
+	unsigned int	m_bvhSize;
+	unsigned int	m_meshHash;
+	unsigned int	m_numParts;
+	unsigned int	m_offsets[LANDSCAPE_PARTS];
+	unsigned int	m_sizes[LANDSCAPE_PARTS];
+	btScalar	m_aabbMin[LANDSCAPE_PARTS][3];
+	btScalar	m_aabbMax[LANDSCAPE_PARTS][3];
+};
+
+static const char	landscapeBvhCacheMagic[8] = {'B','T','B','V','H','C','1',0};
+
+static void	initLandscapeBvhCacheHeader(LandscapeBvhCacheHeader& header)
+{
+	memset(&header,0,sizeof(header));
+	memcpy(header.m_magic,landscapeBvhCacheMagic,sizeof(header.m_magic));
+	header.m_pointerSize = sizeof(void*);
+	header.m_scalarSize = sizeof(btScalar);
+	header.m_bvhSize = sizeof(btQuantizedBvh);
+	header.m_meshHash = landscapeHash();
+	header.m_numParts = LANDSCAPE_PARTS;
+}
+
+static bool	isValidLandscapeBvhCache(const void* data, unsigned int size)
+{
+	if (size < sizeof(LandscapeBvhCacheHeader))
+		return false;
+	const LandscapeBvhCacheHeader& cached = *(const LandscapeBvhCacheHeader*)data;
+	LandscapeBvhCacheHeader expected;
+	initLandscapeBvhCacheHeader(expected);
+	if (memcmp(&cached,&expected,(const char*)&expected.m_offsets-(const char*)&expected) != 0)
+		return false;
+	for (int i=0;i<LANDSCAPE_PARTS;i++)
+	{
+		if ((cached.m_offsets[i] & 15) != 0 || cached.m_offsets[i] > size || cached.m_sizes[i] > size-cached.m_offsets[i])
+			return false;
+	}
+	return true;
+}
+
+bool	checkLandscapeBvhCache(const char* path)
+{
+	FILE* file = fopen(path,"rb");
+	if (!file)
+		return false;
+	LandscapeBvhCacheHeader header;
+	bool valid = false;
+	if (fread(&header,sizeof(header),1,file) == 1 && fseek(file,0,SEEK_END) == 0)
+		valid = isValidLandscapeBvhCache(&header,(unsigned int)ftell(file));
+	fclose(file);
+	return valid;
+}
+
+bool	writeLandscapeBvhCache(const char* path)
+{
+	LandscapeBvhCacheHeader header;
+	initLandscapeBvhCacheHeader(header);
+	btAlignedObjectArray<void*> buffers;
+	unsigned int offset = (sizeof(header)+15) & ~15u;
+	for (int i=0;i<LANDSCAPE_PARTS;i++)
+	{
+		btTriangleIndexVertexArray* meshInterface = createLandscapeMesh(i);
+		btBvhTriangleMeshShape* trimeshShape = new btBvhTriangleMeshShape(meshInterface,true);
+		btOptimizedBvh* bvh = trimeshShape->getOptimizedBvh();
+		unsigned int size = bvh->calculateSerializeBufferSize();
+		void* buffer = btAlignedAlloc(size,16);
+		bvh->serializeInPlace(buffer,size,false);
+		buffers.push_back(buffer);
+		header.m_offsets[i] = offset;
+		header.m_sizes[i] = size;
+		for (int axis=0;axis<3;axis++)
+		{
+			header.m_aabbMin[i][axis] = trimeshShape->getLocalAabbMin()[axis];
+			header.m_aabbMax[i][axis] = trimeshShape->getLocalAabbMax()[axis];
+		}
+		offset = (offset+size+15) & ~15u;
+		delete trimeshShape;
+		delete meshInterface;
+	}
+
+	///the cache is written to a file of its own and renamed into place, so that a run never maps a cache
+	///that is still being written or truncated
+	char temporaryPath[1024];
+#ifdef USE_MMAP_BVH_CACHE
+	snprintf(temporaryPath,sizeof(temporaryPath),"%s.%d.tmp",path,(int)getpid());
+#else
+	snprintf(temporaryPath,sizeof(temporaryPath),"%s.tmp",path);
+#endif //USE_MMAP_BVH_CACHE
+	bool written = false;
+	FILE* file = fopen(temporaryPath,"wb");
+	if (file)
+	{
+		static const char padding[16] = {0};
+		written = fwrite(&header,sizeof(header),1,file) == 1;
+		unsigned int position = sizeof(header);
+		for (int i=0;i<LANDSCAPE_PARTS && written;i++)
+		{
+			written = fwrite(padding,1,header.m_offsets[i]-position,file) == header.m_offsets[i]-position &&
+				fwrite(buffers[i],1,header.m_sizes[i],file) == header.m_sizes[i];
+			position = header.m_offsets[i]+header.m_sizes[i];
+		}
+		written = (fclose(file) == 0) && written;
+#ifndef USE_MMAP_BVH_CACHE
+		///rename does not replace an existing file everywhere
+		if (written)
+			remove(path);
+#endif //USE_MMAP_BVH_CACHE
+		written = written && rename(temporaryPath,path) == 0;
+		if (!written)
+			remove(temporaryPath);
+	}
+	for (int i=0;i<buffers.size();i++)
+		btAlignedFree(buffers[i]);
+	return written;
+}
+
+bool	BenchmarkDemo::mapBvhCache()
+{
+	if (m_bvhCacheData)
+		return true;
+#ifdef USE_MMAP_BVH_CACHE
+	///a private mapping shares the nodes with the page cache, only the pages that
+	///deSerializeInPlace fixes up are copied
+	int fd = open(gBvhCachePath,O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat status;
+	if (fstat(fd,&status) == 0 && status.st_size > 0)
+	{
+		void* data = mmap(0,status.st_size,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,0);
+		if (data != MAP_FAILED)
+		{
+			m_bvhCacheData = data;
+			m_bvhCacheSize = (unsigned int)status.st_size;
+		}
+	}
+	close(fd);
+#else
+	FILE* file = fopen(gBvhCachePath,"rb");
+	if (!file)
+		return false;
+	if (fseek(file,0,SEEK_END) == 0)
+	{
+		long size = ftell(file);
+		void* data = size > 0 ? btAlignedAlloc(size,16) : 0;
+		if (data && fseek(file,0,SEEK_SET) == 0 && fread(data,1,size,file) == (size_t)size)
+		{
+			m_bvhCacheData = data;
+			m_bvhCacheSize = (unsigned int)size;
+		}
+		else if (data)
+		{
+			btAlignedFree(data);
+		}
+	}
+	fclose(file);
+#endif //USE_MMAP_BVH_CACHE
+	if (m_bvhCacheData && !isValidLandscapeBvhCache(m_bvhCacheData,m_bvhCacheSize))
+		unmapBvhCache();
+	return m_bvhCacheData != 0;
+}
+
+void	BenchmarkDemo::unmapBvhCache()
+{
+	if (!m_bvhCacheData)
+		return;
+#ifdef USE_MMAP_BVH_CACHE
+	munmap(m_bvhCacheData,m_bvhCacheSize);
+#else
+	btAlignedFree(m_bvhCacheData);
+#endif //USE_MMAP_BVH_CACHE
+	m_bvhCacheData = 0;
+	m_bvhCacheSize = 0;
+}
+
 void BenchmarkDemo::createLargeMeshBody()
 {
 	btTransform trans;
 	trans.setIdentity();
 
-	for(int i=0;i<8;i++) {
-
-		btTriangleIndexVertexArray* meshInterface = new btTriangleIndexVertexArray();
-		btIndexedMesh part;
+	///start-up of the trimesh demos is dominated by building the BVHs, unless they are loaded from the cache
+	const char* interval = gBvhCachePath ? "loadBvh" : "buildBvh";
+	wasm_perf_mark_begin(interval, m_benchmark);
+	if (gBvhCachePath && !mapBvhCache())
+		printf("error: cannot load the BVH cache %s, building the BVHs\n",gBvhCachePath);
+	const LandscapeBvhCacheHeader* cacheHeader = (const LandscapeBvhCacheHeader*)m_bvhCacheData;
 
-		part.m_vertexBase = (const unsigned char*)LandscapeVtx[i];
-		part.m_vertexStride = sizeof(btScalar) * 3;
-		part.m_numVertices = LandscapeVtxCount[i];
-		part.m_triangleIndexBase = (const unsigned char*)LandscapeIdx[i];
-		part.m_triangleIndexStride = sizeof( short) * 3;
-		part.m_numTriangles = LandscapeIdxCount[i]/3;
-		part.m_indexType = PHY_SHORT;
+	for(int i=0;i<LANDSCAPE_PARTS;i++) {
 
-		meshInterface->addIndexedMesh(part,PHY_SHORT);
+		btTriangleIndexVertexArray* meshInterface = createLandscapeMesh(i);
+		m_meshInterfaces.push_back(meshInterface);
 
 		bool	useQuantizedAabbCompression = true;
-		btBvhTriangleMeshShape* trimeshShape = new btBvhTriangleMeshShape(meshInterface,useQuantizedAabbCompression);
+		btBvhTriangleMeshShape* trimeshShape;
+		if (cacheHeader)
+		{
+			meshInterface->setPremadeAabb(
+				btVector3(cacheHeader->m_aabbMin[i][0],cacheHeader->m_aabbMin[i][1],cacheHeader->m_aabbMin[i][2]),
+				btVector3(cacheHeader->m_aabbMax[i][0],cacheHeader->m_aabbMax[i][1],cacheHeader->m_aabbMax[i][2]));
+			trimeshShape = new btBvhTriangleMeshShape(meshInterface,useQuantizedAabbCompression,false);
+			btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace((char*)m_bvhCacheData+cacheHeader->m_offsets[i],cacheHeader->m_sizes[i],false);
+			btAssert(bvh);
+			trimeshShape->setOptimizedBvh(bvh);
+		}
+		else
+		{
+			trimeshShape = new btBvhTriangleMeshShape(meshInterface,useQuantizedAabbCompression);
+		}
+		m_collisionShapes.push_back(trimeshShape);
 		btVector3 localInertia(0,0,0);
 		trans.setOrigin(btVector3(0,-25,0));
 
@@ -1095,6 +1432,7 @@ void BenchmarkDemo::createLargeMeshBody()
 		body->setFriction (btScalar(0.9));
 		
 	}
+	wasm_perf_mark_end(interval, m_benchmark);
 	
 }
 
@@ -1228,11 +1566,32 @@ void	BenchmarkDemo::createTest6()
 void BenchmarkDemo::initRays()
 {
 	raycastBar = btRaycastBar2 (2500.0, 0,50.0);
+	if (gBatchRaycast)
+	{
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+		if (gParallelThreads > 0)
+		{
+			m_batchRaycasterThreadSupport = createRaycastThreadSupport(gParallelThreads);
+			m_batchRaycaster = new btParallelBatchRaycaster(m_dynamicsWorld,m_batchRaycasterThreadSupport);
+		}
+		else
+#endif //USE_PARALLEL_DISPATCHER_BENCHMARK
+		{
+			m_batchRaycaster = new btBatchedRaycaster(m_dynamicsWorld);
+		}
+	}
 }
 
 void BenchmarkDemo::castRays()
 {
-	raycastBar.cast (m_dynamicsWorld);
+	// The "rays" progress only advances during the "castRays" intervals. Its peak rate still counts
+	// the simulation steps between them, the rays per second of the casts alone are the rays over the
+	// total duration of the intervals, see rate_interval in the runner.
+	wasm_perf_mark_begin("castRays", raycastBar.num_casts);
+	wasm_perf_record_progress("rays", raycastBar.num_casts * NUMRAYS);
+	raycastBar.cast (m_dynamicsWorld, m_batchRaycaster);
+	wasm_perf_record_progress("rays", raycastBar.num_casts * NUMRAYS);
+	wasm_perf_mark_end("castRays", raycastBar.num_casts - 1);
 }
 
 void	BenchmarkDemo::createTest7()
@@ -1243,10 +1602,134 @@ void	BenchmarkDemo::createTest7()
 	initRays();
 }
 
+///next value of the linear congruential generator of the broadphase demo, in [0,1)
+static btScalar	nextRandom(unsigned int& random)
+{
+	random = random*1664525u+1013904223u;
+	return btScalar(random>>8)*btScalar(1./16777216.);
+}
+
+void	BenchmarkDemo::createTest8()
+{
+	///the objects fill a cube with about 8 times their own volume, so each overlaps a few neighbours
+	btCollisionShape* sphereShape = new btSphereShape(btScalar(1.));
+	m_collisionShapes.push_back(sphereShape);
+	m_sceneExtent = btScalar(2.)*btPow(btScalar(gBroadphaseObjects),btScalar(1./3.));
+	setCameraDistance(m_sceneExtent*btScalar(4.));
+
+	m_random = 12345;
+	m_velocities.resize(gBroadphaseObjects);
+	for (int i=0;i<gBroadphaseObjects;i++)
+	{
+		btTransform trans;
+		trans.setIdentity();
+		trans.setOrigin(btVector3(
+			(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*m_sceneExtent,
+			(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*m_sceneExtent,
+			(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*m_sceneExtent));
+		m_velocities[i].setValue(
+			(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*btScalar(0.1),
+			(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*btScalar(0.1),
+			(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*btScalar(0.1));
+
+		btCollisionObject* obj = new btCollisionObject();
+		obj->setCollisionShape(sphereShape);
+		obj->setWorldTransform(trans);
+		m_dynamicsWorld->addCollisionObject(obj);
+	}
+
+	m_frames = 0;
+	m_totalPairs = 0;
+	m_addedPairs = 0;
+	m_removedPairs = 0;
+	m_foundPairs = 0;
+}
+
+void	BenchmarkDemo::stepTest8()
+{
+	///this demo does not call stepSimulation, which resets the profile timer that main reports per frame
+#ifndef BT_NO_PROFILE
+	CProfileManager::Reset();
+#endif //BT_NO_PROFILE
+
+	///move every object a little and bounce it off the walls of the cube, except for the objects
+	///that jump to a random place, which the broadphase cannot update incrementally
+	btCollisionObjectArray& objects = m_dynamicsWorld->getCollisionObjectArray();
+	btScalar jumpProbability = btScalar(gBroadphaseJump)*btScalar(0.01);
+	for (int i=0;i<objects.size();i++)
+	{
+		btVector3 origin = objects[i]->getWorldTransform().getOrigin();
+		if (gBroadphaseJump > 0 && nextRandom(m_random) < jumpProbability)
+		{
+			origin.setValue(
+				(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*m_sceneExtent,
+				(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*m_sceneExtent,
+				(nextRandom(m_random)*btScalar(2.)-btScalar(1.))*m_sceneExtent);
+		}
+		else
+		{
+			origin += m_velocities[i];
+			for (int axis=0;axis<3;axis++)
+			{
+				if (btFabs(origin[axis]) > m_sceneExtent)
+					m_velocities[i][axis] = -m_velocities[i][axis];
+			}
+		}
+		objects[i]->getWorldTransform().setOrigin(origin);
+	}
+
+	int addedPairs = gAddedPairs;
+	int removedPairs = gRemovePairs;
+	int foundPairs = gFindPairs;
+
+	///btAxisSweep3 adds and removes most pairs while the proxies are moved, btDbvtBroadphase and
+	///btSimpleBroadphase find them in calculateOverlappingPairs. The intervals are not named after the
+	///BT_PROFILE scopes of these calls, which the stages option records as well.
+	wasm_perf_mark_begin("aabbUpdate", m_frames);
+	m_dynamicsWorld->updateAabbs();
+	wasm_perf_mark_end("aabbUpdate", m_frames);
+	wasm_perf_mark_begin("pairUpdate", m_frames);
+	m_overlappingPairCache->calculateOverlappingPairs(m_dispatcher);
+	wasm_perf_mark_end("pairUpdate", m_frames);
+
+	m_frames++;
+	m_totalPairs += m_pairCache->getNumOverlappingPairs();
+	m_addedPairs += gAddedPairs-addedPairs;
+	m_removedPairs += gRemovePairs-removedPairs;
+	m_foundPairs += gFindPairs-foundPairs;
+
+	///pair cache statistics as work items that count pairs, the counters of the broadphase profiles
+	wasm_perf_record_relative_progress("pairs", float(m_pairCache->getNumOverlappingPairs()));
+	wasm_perf_record_relative_progress("addedPairs", float(gAddedPairs-addedPairs));
+	wasm_perf_record_relative_progress("removedPairs", float(gRemovePairs-removedPairs));
+	wasm_perf_record_relative_progress("foundPairs", float(gFindPairs-foundPairs));
+}
+
 void	BenchmarkDemo::exitPhysics()
 {
 	int i;
 
+	if (m_benchmark==8 && m_dynamicsWorld && m_frames > 0)
+	{
+		printf("broadphase: %d objects, %d%% jumping, per frame %.1f pairs, %.1f added, %.1f removed, %.1f found, pair array capacity %d\n",
+			gBroadphaseObjects,gBroadphaseJump,
+			double(m_totalPairs)/m_frames,double(m_addedPairs)/m_frames,double(m_removedPairs)/m_frames,double(m_foundPairs)/m_frames,
+			m_pairCache->getOverlappingPairArray().capacity());
+	}
+
+	if (m_benchmark==7 && m_dynamicsWorld)
+	{
+		printf("raytests: %d rays, hit hash %08x\n",raycastBar.num_casts * NUMRAYS,raycastBar.hit_hash);
+	}
+
+	delete m_batchRaycaster;
+	m_batchRaycaster=0;
+
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+	delete m_batchRaycasterThreadSupport;
+	m_batchRaycasterThreadSupport=0;
+#endif //USE_PARALLEL_DISPATCHER_BENCHMARK
+
 	for (i=0;i<m_ragdolls.size();i++)
 	{
 		RagDoll* doll = m_ragdolls[i];
@@ -1279,6 +1762,14 @@ void	BenchmarkDemo::exitPhysics()
 	}
     m_collisionShapes.clear();
 
+	for (int j=0;j<m_meshInterfaces.size();j++)
+	{
+		delete m_meshInterfaces[j];
+	}
+	m_meshInterfaces.clear();
+
+	unmapBvhCache();
+
 	//delete dynamics world
 	delete m_dynamicsWorld;
     m_dynamicsWorld=0;
@@ -1287,14 +1778,29 @@ void	BenchmarkDemo::exitPhysics()
 	delete m_solver;
     m_solver=0;
 
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+	delete m_solverThreadSupport;
+	m_solverThreadSupport=0;
+#endif //USE_PARALLEL_DISPATCHER_BENCHMARK
+
 	//delete broadphase
 	delete m_overlappingPairCache;
     m_overlappingPairCache=0;
 
+	delete m_pairCache;
+	m_pairCache=0;
+
+	m_velocities.clear();
+
 	//delete dispatcher
 	delete m_dispatcher;
     m_dispatcher=0;
 
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+	delete m_collisionThreadSupport;
+	m_collisionThreadSupport=0;
+#endif //USE_PARALLEL_DISPATCHER_BENCHMARK
+
 	delete m_collisionConfiguration;
     m_collisionConfiguration=0;
 
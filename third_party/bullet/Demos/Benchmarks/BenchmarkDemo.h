@@ -23,6 +23,42 @@ class btDynamicsWorld;
 
 #define NUMRAYS 500
 
+///Number of threads for the parallel collision dispatcher and constraint solver of a build with
+///USE_PARALLEL_DISPATCHER_BENCHMARK. 0 uses btCollisionDispatcher and the sequential solver.
+extern int gParallelThreads;
+
+///Cast the rays of the raytests demo as one batch with btBatchedRaycaster, split over gParallelThreads threads
+///in a build with USE_PARALLEL_DISPATCHER_BENCHMARK. false casts one btCollisionWorld::rayTest per ray.
+extern bool gBatchRaycast;
+
+///Broadphase of every demo, btAxisSweep3 (bt32BitAxisSweep3 for more than 32766 objects) by default.
+enum BenchmarkBroadphase
+{
+	BENCHMARK_BROADPHASE_AXIS_SWEEP,
+	BENCHMARK_BROADPHASE_DBVT,
+	BENCHMARK_BROADPHASE_SIMPLE
+};
+extern BenchmarkBroadphase gBroadphase;
+
+///Number of objects of the broadphase demo.
+extern int gBroadphaseObjects;
+
+///Percentage of the objects of the broadphase demo that jump to a random place each frame instead of
+///moving a little, 0 for a fully coherent scene and 100 for a new random scene every frame.
+extern int gBroadphaseJump;
+
+///Serialized BVH cache of the landscape of the trimesh demos. The BVHs are mapped from this file with
+///btOptimizedBvh::deSerializeInPlace instead of being built, 0 builds them on every initPhysics.
+extern const char* gBvhCachePath;
+
+///Returns false if the BVH cache at path is missing or was built for another mesh, pointer size or
+///btQuantizedBvh layout.
+bool	checkLandscapeBvhCache(const char* path);
+
+///Builds the landscape BVHs and writes them to the BVH cache at path. Returns false if the cache cannot
+///be written.
+bool	writeLandscapeBvhCache(const char* path);
+
 class btRigidBody;
 class btBroadphaseInterface;
 class btCollisionShape;
@@ -104,24 +140,72 @@ class BenchmarkDemo : public PlatformDemoApplication
 	void	createTest5();
 	void	createTest6();
 	void	createTest7();
+	void	createTest8();
+	void	stepTest8();
 
 	void createWall(const btVector3& offsetPosition,int stackSize,const btVector3& boxSize);
 	void createPyramid(const btVector3& offsetPosition,int stackSize,const btVector3& boxSize);
 	void createTowerCircle(const btVector3& offsetPosition,int stackSize,int rotSize,const btVector3& boxSize);
 	void createLargeMeshBody();
 
+	///gBvhCachePath mapped into memory, it has to outlive the trimesh shapes whose BVHs live in it
+	void*	m_bvhCacheData;
+	unsigned int	m_bvhCacheSize;
+	btAlignedObjectArray<class btStridingMeshInterface*>	m_meshInterfaces;
+
+	bool	mapBvhCache();
+	void	unmapBvhCache();
+
 
-	class SpuBatchRaycaster* m_batchRaycaster;
+	class btBatchedRaycaster* m_batchRaycaster;
 	class btThreadSupportInterface* m_batchRaycasterThreadSupport;
 
+	///threads of the parallel dispatcher and solver, see gParallelThreads
+	class btThreadSupportInterface* m_collisionThreadSupport;
+	class btThreadSupportInterface* m_solverThreadSupport;
+
+	///shared by the broadphase, which only deletes a pair cache it created itself
+	btOverlappingPairCache*	m_pairCache;
+
+	///objects of the broadphase demo: velocity per object and the state of its random generator
+	btAlignedObjectArray<btVector3>	m_velocities;
+	btScalar	m_sceneExtent;
+	unsigned int	m_random;
+
+	///pair cache statistics of the broadphase demo
+	int	m_frames;
+	long long	m_totalPairs;
+	long long	m_addedPairs;
+	long long	m_removedPairs;
+	long long	m_foundPairs;
+
 	void castRays();
 	void initRays();
 
 	public:
 
 	BenchmarkDemo(int benchmark)
-	:m_benchmark(benchmark)
+	:m_overlappingPairCache(0),
+	m_dispatcher(0),
+	m_solver(0),
+	m_collisionConfiguration(0),
+	m_benchmark(benchmark),
+	m_bvhCacheData(0),
+	m_bvhCacheSize(0),
+	m_batchRaycaster(0),
+	m_batchRaycasterThreadSupport(0),
+	m_collisionThreadSupport(0),
+	m_solverThreadSupport(0),
+	m_pairCache(0),
+	m_sceneExtent(0),
+	m_random(0),
+	m_frames(0),
+	m_totalPairs(0),
+	m_addedPairs(0),
+	m_removedPairs(0),
+	m_foundPairs(0)
 	{
+		m_dynamicsWorld = 0;
 	}
 	virtual ~BenchmarkDemo()
 	{
@@ -261,5 +345,22 @@ public:
 	}
 };
 
+class BenchmarkDemo8 : public BenchmarkDemo
+{
+public:
+	BenchmarkDemo8()
+		:BenchmarkDemo(8)
+	{
+	}
+
+	static DemoApplication* Create()
+	{
+		BenchmarkDemo8* demo = new BenchmarkDemo8;
+		demo->myinit();
+		demo->initPhysics();
+		return demo;
+	}
+};
+
 #endif //BENCHMARK_DEMO_H
 
@@ -17,6 +17,9 @@ subject to the following restrictions:
 #include "btBulletDynamicsCommon.h"
 #include "LinearMath/btHashMap.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wasm_perf.h"
 
 #ifdef USE_GRAPHICAL_BENCHMARK
 	#include "GlutStuff.h"
@@ -26,7 +29,7 @@ subject to the following restrictions:
 #endif //USE_GRAPHICAL_BENCHMARK
 
 
-#define NUM_DEMOS 7
+#define NUM_DEMOS 8
 
 extern bool gDisableDeactivation;
 
@@ -52,10 +55,92 @@ int main(int argc, char **argv) {
 	BenchmarkDemo5 benchmarkDemo5;
 	BenchmarkDemo6 benchmarkDemo6;
 	BenchmarkDemo7 benchmarkDemo7;
+	BenchmarkDemo8 benchmarkDemo8;
 
-	BenchmarkDemo* demoArray[NUM_DEMOS] = {&benchmarkDemo1,&benchmarkDemo2,&benchmarkDemo3,&benchmarkDemo4,&benchmarkDemo5,&benchmarkDemo6,&benchmarkDemo7};
-	const char* demoNames[NUM_DEMOS] = {"3000 fall", "1000 stack", "136 ragdolls","1000 convex", "prim-trimesh", "convex-trimesh","raytests"};
-	float totalTime[NUM_DEMOS] = {0.f,0.f,0.f,0.f,0.f,0.f,0.f};
+	BenchmarkDemo* demoArray[NUM_DEMOS] = {&benchmarkDemo1,&benchmarkDemo2,&benchmarkDemo3,&benchmarkDemo4,&benchmarkDemo5,&benchmarkDemo6,&benchmarkDemo7,&benchmarkDemo8};
+	const char* demoNames[NUM_DEMOS] = {"3000 fall", "1000 stack", "136 ragdolls","1000 convex", "prim-trimesh", "convex-trimesh","raytests","broadphase"};
+	float totalTime[NUM_DEMOS] = {0.f,0.f,0.f,0.f,0.f,0.f,0.f,0.f};
+
+	// Optionally run a single demo, numbered from 1 (0 for all but the broadphase demo), and record its stages.
+	int firstDemo = 0;
+	int lastDemo = NUM_DEMOS - 2;
+	if (argc > 2)
+	{
+		int demo = atoi(argv[2]);
+		if (demo < 0 || demo > NUM_DEMOS)
+		{
+			printf("error: unknown demo %s\n", argv[2]);
+			return -1;
+		}
+		if (demo > 0)
+			firstDemo = lastDemo = demo - 1;
+	}
+	// Options: stages, threads=<count> for the parallel dispatcher and solver, rays=single|batch for
+	// the ray casts of the raytests demo, broadphase=axissweep|dbvt|simple, objects=<count> and
+	// jump=<percent> for the broadphase demo, and bvh=build|cache for the landscape of the trimesh demos
+	bool useBvhCache = false;
+	for (int option = 3; option < argc; option++)
+	{
+		if (strcmp(argv[option], "stages") == 0)
+		{
+#ifdef BT_WASM_PERF_PROFILE
+			gWasmPerfProfile = true;
+#else
+			printf("error: built without BT_WASM_PERF_PROFILE\n");
+			return -1;
+#endif //BT_WASM_PERF_PROFILE
+		}
+		else if (strncmp(argv[option], "threads=", 8) == 0 && atoi(argv[option] + 8) > 0)
+		{
+#ifdef USE_PARALLEL_DISPATCHER_BENCHMARK
+			gParallelThreads = atoi(argv[option] + 8);
+#else
+			printf("error: built without USE_PARALLEL_DISPATCHER_BENCHMARK\n");
+			return -1;
+#endif //USE_PARALLEL_DISPATCHER_BENCHMARK
+		}
+		else if (strcmp(argv[option], "rays=single") == 0)
+		{
+			gBatchRaycast = false;
+		}
+		else if (strcmp(argv[option], "rays=batch") == 0)
+		{
+			gBatchRaycast = true;
+		}
+		else if (strcmp(argv[option], "broadphase=axissweep") == 0)
+		{
+			gBroadphase = BENCHMARK_BROADPHASE_AXIS_SWEEP;
+		}
+		else if (strcmp(argv[option], "broadphase=dbvt") == 0)
+		{
+			gBroadphase = BENCHMARK_BROADPHASE_DBVT;
+		}
+		else if (strcmp(argv[option], "broadphase=simple") == 0)
+		{
+			gBroadphase = BENCHMARK_BROADPHASE_SIMPLE;
+		}
+		else if (strncmp(argv[option], "objects=", 8) == 0 && atoi(argv[option] + 8) > 0)
+		{
+			gBroadphaseObjects = atoi(argv[option] + 8);
+		}
+		else if (strcmp(argv[option], "bvh=build") == 0)
+		{
+			useBvhCache = false;
+		}
+		else if (strcmp(argv[option], "bvh=cache") == 0)
+		{
+			useBvhCache = true;
+		}
+		else if (strncmp(argv[option], "jump=", 5) == 0 && atoi(argv[option] + 5) >= 0 && atoi(argv[option] + 5) <= 100)
+		{
+			gBroadphaseJump = atoi(argv[option] + 5);
+		}
+		else
+		{
+			printf("error: unknown option %s\n", argv[option]);
+			return -1;
+		}
+	}
 
 #ifdef USE_GRAPHICAL_BENCHMARK
 	benchmarkDemo.initPhysics();
@@ -64,15 +149,35 @@ int main(int argc, char **argv) {
 	return glutmain(argc, argv,640,480,"Bullet Physics Demo. http://bulletphysics.com",&benchmarkDemo);
 
 #else //USE_GRAPHICAL_BENCHMARK
+	// The BVH cache lives next to the binary. The build writes it with bvh_cache, and Wasm binaries
+	// have it embedded in the root of their file system, where argv[0] points as well.
+	char bvhCachePath[1024];
+	if (useBvhCache)
+	{
+		const char* binaryDir = strrchr(argv[0], '/');
+		int binaryDirLength = binaryDir ? int(binaryDir - argv[0]) + 1 : 0;
+		snprintf(bvhCachePath, sizeof(bvhCachePath), "%.*slandscape.bvh", binaryDirLength, argv[0]);
+		if (!checkLandscapeBvhCache(bvhCachePath))
+		{
+			printf("error: missing or stale BVH cache %s\n", bvhCachePath);
+			return -1;
+		}
+		gBvhCachePath = bvhCachePath;
+	}
+
 	int d;
 
-	for (d=0;d<NUM_DEMOS;d++)
+	for (d=firstDemo;d<=lastDemo;d++)
 	{
+		// Every demo is its own progress stream counting simulated frames.
+		wasm_perf_mark_begin("initPhysics", d);
 		demoArray[d]->initPhysics();
+		wasm_perf_mark_end("initPhysics", d);
 		
 
 		for (int i=0;i<NUM_TESTS;i++)
 		{
+			wasm_perf_record_progress(demoNames[d], i);
 			demoArray[d]->clientMoveAndDisplay();
 			float frameTime = CProfileManager::Get_Time_Since_Reset();
 			if ((i % 25)==0)
@@ -85,10 +190,13 @@ int main(int argc, char **argv) {
 
 			
 		}
+		wasm_perf_record_progress(demoNames[d], NUM_TESTS);
+		wasm_perf_mark_begin("exitPhysics", d);
         demoArray[d]->exitPhysics();
+		wasm_perf_mark_end("exitPhysics", d);
 	}
 
-	for (d=0;d<NUM_DEMOS;d++)
+	for (d=firstDemo;d<=lastDemo;d++)
 	{
 		printf("Results for %s: %f\n",demoNames[d],totalTime[d]*(1.f/NUM_TESTS));
 	}
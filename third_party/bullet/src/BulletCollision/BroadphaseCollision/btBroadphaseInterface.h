@@ -23,6 +23,7 @@ class btDispatcher;
 #include "btBroadphaseProxy.h"
 
 class btOverlappingPairCache;
+struct btDbvtBroadphase;
 
 
 
@@ -75,6 +76,9 @@ public:
 	///reset broadphase internal structures, to ensure determinism/reproducability
 	virtual void resetPool(btDispatcher* dispatcher) { (void) dispatcher; };
 
+	///getRaycastAccelerator returns the btDbvtBroadphase that rayTest uses, if any, so that batched ray tests can walk its trees directly
+	virtual const btDbvtBroadphase*	getRaycastAccelerator() const { return 0; }
+
 	virtual void	printStats() = 0;
 
 };
@@ -121,6 +121,11 @@ struct	btDbvtBroadphase : btBroadphaseInterface
 	///reset broadphase internal structures, to ensure determinism/reproducability
 	virtual void resetPool(btDispatcher* dispatcher);
 
+	virtual const btDbvtBroadphase*	getRaycastAccelerator() const
+	{
+		return this;
+	}
+
 	void	performDeferredRemoval(btDispatcher* dispatcher);
 	
 	void	setVelocityPrediction(btScalar prediction)
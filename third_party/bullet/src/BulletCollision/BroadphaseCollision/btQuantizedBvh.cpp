@@ -18,6 +18,7 @@ subject to the following restrictions:
 #include "LinearMath/btAabbUtil2.h"
 #include "LinearMath/btIDebugDraw.h"
 #include "LinearMath/btSerializer.h"
+#include "btRayPacket.h"
 
 #define RAYAABB2
 
@@ -787,6 +788,116 @@ void	btQuantizedBvh::reportBoxCastOverlappingNodex(btNodeOverlapCallback* nodeCa
 }
 
 
+void	btQuantizedBvh::walkStacklessQuantizedTreeAgainstRayPacket(btNodePacketOverlapCallback* nodeCallback, const btVector3* raySource, const btVector3* rayTarget, int numRays, int startNodeIndex,int endNodeIndex) const
+{
+	btAssert(m_useQuantization);
+	btAssert(numRays > 0 && numRays <= BT_RAY_PACKET_SIZE);
+
+	btRayPacket packet;
+	packet.init(raySource,rayTarget,numRays);
+
+	/* Quick pruning by quantized box, for every ray */
+	unsigned short int quantizedQueryAabbMin[BT_RAY_PACKET_SIZE][3];
+	unsigned short int quantizedQueryAabbMax[BT_RAY_PACKET_SIZE][3];
+	///a ray that misses an internal node skips its subtree and rejoins the walk at the escape index
+	int resumeIndex[BT_RAY_PACKET_SIZE];
+	int ray;
+	for (ray=0;ray<numRays;ray++)
+	{
+		btVector3 rayAabbMin = raySource[ray];
+		btVector3 rayAabbMax = raySource[ray];
+		rayAabbMin.setMin(rayTarget[ray]);
+		rayAabbMax.setMax(rayTarget[ray]);
+		quantizeWithClamp(quantizedQueryAabbMin[ray],rayAabbMin,0);
+		quantizeWithClamp(quantizedQueryAabbMax[ray],rayAabbMax,1);
+		resumeIndex[ray] = startNodeIndex;
+	}
+
+	int curIndex = startNodeIndex;
+	while (curIndex < endNodeIndex)
+	{
+		unsigned int activeRays = 0;
+		int nextIndex = endNodeIndex;
+		for (ray=0;ray<numRays;ray++)
+		{
+			if (resumeIndex[ray] <= curIndex)
+				activeRays |= 1<<ray;
+			else
+				nextIndex = btMin(nextIndex,resumeIndex[ray]);
+		}
+		if (!activeRays)
+		{
+			curIndex = nextIndex;
+			continue;
+		}
+
+		const btQuantizedBvhNode* rootNode = &m_quantizedContiguousNodes[curIndex];
+		unsigned int boxBoxOverlap = 0;
+		for (ray=0;ray<numRays;ray++)
+		{
+			if ((activeRays & (1<<ray)) && testQuantizedAabbAgainstQuantizedAabb(quantizedQueryAabbMin[ray],quantizedQueryAabbMax[ray],rootNode->m_quantizedAabbMin,rootNode->m_quantizedAabbMax))
+				boxBoxOverlap |= 1<<ray;
+		}
+		unsigned int rayBoxOverlap = 0;
+		if (boxBoxOverlap)
+		{
+			rayBoxOverlap = packet.testAabb(unQuantize(rootNode->m_quantizedAabbMin),unQuantize(rootNode->m_quantizedAabbMax)) & boxBoxOverlap;
+		}
+
+		if (rootNode->isLeafNode())
+		{
+			if (rayBoxOverlap)
+				nodeCallback->processNode(rootNode->getPartId(),rootNode->getTriangleIndex(),rayBoxOverlap);
+			curIndex++;
+		} else
+		{
+			int escapeIndex = rootNode->getEscapeIndex();
+			unsigned int missedRays = activeRays & ~rayBoxOverlap;
+			for (ray=0;ray<numRays;ray++)
+			{
+				if (missedRays & (1<<ray))
+					resumeIndex[ray] = curIndex + escapeIndex;
+			}
+			curIndex += rayBoxOverlap ? 1 : escapeIndex;
+		}
+	}
+}
+
+void	btQuantizedBvh::reportRayPacketOverlappingNodex(btNodePacketOverlapCallback* nodeCallback, const btVector3* raySource, const btVector3* rayTarget, int numRays) const
+{
+	if (m_useQuantization)
+	{
+		walkStacklessQuantizedTreeAgainstRayPacket(nodeCallback, raySource, rayTarget, numRays, 0, m_curNodeIndex);
+	}
+	else
+	{
+		///the non-quantized tree is walked once per ray
+		struct	RayNodeOverlapCallback : public btNodeOverlapCallback
+		{
+			btNodePacketOverlapCallback*	m_packetCallback;
+			unsigned int	m_rayMask;
+
+			RayNodeOverlapCallback(btNodePacketOverlapCallback* packetCallback,unsigned int rayMask)
+				:m_packetCallback(packetCallback),
+				m_rayMask(rayMask)
+			{
+			}
+
+			virtual void processNode(int subPart, int triangleIndex)
+			{
+				m_packetCallback->processNode(subPart,triangleIndex,m_rayMask);
+			}
+		};
+
+		for (int ray=0;ray<numRays;ray++)
+		{
+			RayNodeOverlapCallback rayCallback(nodeCallback,1<<ray);
+			reportRayOverlappingNodex(&rayCallback,raySource[ray],rayTarget[ray]);
+		}
+	}
+}
+
+
 void	btQuantizedBvh::swapLeafNodes(int i,int splitIndex)
 {
 	if (m_useQuantization)
@@ -0,0 +1,124 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2009 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_RAY_PACKET_H
+#define BT_RAY_PACKET_H
+
+#include "LinearMath/btVector3.h"
+
+#if defined (__SSE2__) && !defined (BT_USE_DOUBLE_PRECISION)
+#define BT_RAY_PACKET_SSE
+#include <emmintrin.h>
+#elif defined (__wasm_simd128__) && !defined (BT_USE_DOUBLE_PRECISION)
+#define BT_RAY_PACKET_WASM_SIMD
+#include <wasm_simd128.h>
+#endif
+
+///number of rays that are tested against a box at once
+#define BT_RAY_PACKET_SIZE 4
+
+///btRayPacket stores up to BT_RAY_PACKET_SIZE rays in structure of arrays layout, so that a single slab test
+///checks a box against all of them. Every ray is set up like btSingleRayCallback does it for btRayAabb2,
+///so a packet reports exactly the boxes that the rays would report one by one.
+ATTRIBUTE_ALIGNED16(struct) btRayPacket
+{
+	btScalar	m_origin[3][BT_RAY_PACKET_SIZE];
+	btScalar	m_directionInverse[3][BT_RAY_PACKET_SIZE];
+	btScalar	m_lambdaMax[BT_RAY_PACKET_SIZE];
+	int			m_numRays;
+
+	///unused lanes have a lambda max of 0, which no box passes
+	void	init(const btVector3* rayFrom, const btVector3* rayTo, int numRays)
+	{
+		btAssert(numRays > 0 && numRays <= BT_RAY_PACKET_SIZE);
+		m_numRays = numRays;
+		for (int lane=0;lane<BT_RAY_PACKET_SIZE;lane++)
+		{
+			if (lane >= numRays)
+			{
+				for (int axis=0;axis<3;axis++)
+				{
+					m_origin[axis][lane] = btScalar(0.);
+					m_directionInverse[axis][lane] = btScalar(0.);
+				}
+				m_lambdaMax[lane] = btScalar(0.);
+				continue;
+			}
+			btVector3 rayDir = rayTo[lane]-rayFrom[lane];
+			rayDir.normalize();
+			for (int axis=0;axis<3;axis++)
+			{
+				m_origin[axis][lane] = rayFrom[lane][axis];
+				m_directionInverse[axis][lane] = rayDir[axis] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / rayDir[axis];
+			}
+			m_lambdaMax[lane] = rayDir.dot(rayTo[lane]-rayFrom[lane]);
+		}
+	}
+
+	///returns one bit per ray that enters the box [aabbMin,aabbMax] in (0,lambda max), the same as btRayAabb2
+	SIMD_FORCE_INLINE unsigned int	testAabb(const btVector3& aabbMin, const btVector3& aabbMax) const
+	{
+#if defined (BT_RAY_PACKET_SSE)
+		__m128 tNear = _mm_set1_ps(-BT_LARGE_FLOAT);
+		__m128 tFar = _mm_set1_ps(BT_LARGE_FLOAT);
+		for (int axis=0;axis<3;axis++)
+		{
+			__m128 origin = _mm_load_ps(m_origin[axis]);
+			__m128 directionInverse = _mm_load_ps(m_directionInverse[axis]);
+			__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(aabbMin[axis]),origin),directionInverse);
+			__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(aabbMax[axis]),origin),directionInverse);
+			tNear = _mm_max_ps(tNear,_mm_min_ps(t0,t1));
+			tFar = _mm_min_ps(tFar,_mm_max_ps(t0,t1));
+		}
+		__m128 hit = _mm_and_ps(_mm_cmple_ps(tNear,tFar),
+			_mm_and_ps(_mm_cmplt_ps(tNear,_mm_load_ps(m_lambdaMax)),_mm_cmpgt_ps(tFar,_mm_setzero_ps())));
+		return (unsigned int)_mm_movemask_ps(hit);
+#elif defined (BT_RAY_PACKET_WASM_SIMD)
+		v128_t tNear = wasm_f32x4_splat(-BT_LARGE_FLOAT);
+		v128_t tFar = wasm_f32x4_splat(BT_LARGE_FLOAT);
+		for (int axis=0;axis<3;axis++)
+		{
+			v128_t origin = wasm_v128_load(m_origin[axis]);
+			v128_t directionInverse = wasm_v128_load(m_directionInverse[axis]);
+			v128_t t0 = wasm_f32x4_mul(wasm_f32x4_sub(wasm_f32x4_splat(aabbMin[axis]),origin),directionInverse);
+			v128_t t1 = wasm_f32x4_mul(wasm_f32x4_sub(wasm_f32x4_splat(aabbMax[axis]),origin),directionInverse);
+			tNear = wasm_f32x4_pmax(tNear,wasm_f32x4_pmin(t0,t1));
+			tFar = wasm_f32x4_pmin(tFar,wasm_f32x4_pmax(t0,t1));
+		}
+		v128_t hit = wasm_v128_and(wasm_f32x4_le(tNear,tFar),
+			wasm_v128_and(wasm_f32x4_lt(tNear,wasm_v128_load(m_lambdaMax)),wasm_f32x4_gt(tFar,wasm_f32x4_splat(0.f))));
+		return (unsigned int)wasm_i32x4_bitmask(hit);
+#else
+		unsigned int mask = 0;
+		for (int lane=0;lane<BT_RAY_PACKET_SIZE;lane++)
+		{
+			btScalar tNear = -BT_LARGE_FLOAT;
+			btScalar tFar = BT_LARGE_FLOAT;
+			for (int axis=0;axis<3;axis++)
+			{
+				btScalar t0 = (aabbMin[axis]-m_origin[axis][lane])*m_directionInverse[axis][lane];
+				btScalar t1 = (aabbMax[axis]-m_origin[axis][lane])*m_directionInverse[axis][lane];
+				tNear = btMax(tNear,btMin(t0,t1));
+				tFar = btMin(tFar,btMax(t0,t1));
+			}
+			if (tNear <= tFar && tNear < m_lambdaMax[lane] && tFar > btScalar(0.))
+				mask |= 1<<lane;
+		}
+		return mask;
+#endif
+	}
+};
+
+#endif //BT_RAY_PACKET_H
@@ -0,0 +1,302 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2009 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btBatchedRaycaster.h"
+#include "btCollisionWorld.h"
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
+
+///bits of the sort key per axis of the ray midpoint, below the three bits of the direction octant
+#define BT_RAY_SORT_BITS 9
+
+///spread the lower BT_RAY_SORT_BITS bits of x so that there are two zero bits between each of them
+static unsigned int btSpreadBits(unsigned int x)
+{
+	x &= (1<<BT_RAY_SORT_BITS)-1;
+	x = (x | (x << 16)) & 0x030000FF;
+	x = (x | (x << 8)) & 0x0300F00F;
+	x = (x | (x << 4)) & 0x030C30C3;
+	x = (x | (x << 2)) & 0x09249249;
+	return x;
+}
+
+class btRaySortPredicate
+{
+public:
+	template <typename T>
+	bool operator() ( const T& a, const T& b ) const
+	{
+		return a.m_key < b.m_key || (a.m_key == b.m_key && a.m_ray < b.m_ray);
+	}
+};
+
+///btPacketRayResultCallback is a ClosestRayResultCallback that can live in an array, the rays are set per packet
+struct btPacketRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+	btPacketRayResultCallback()
+		:btCollisionWorld::ClosestRayResultCallback(btVector3(0,0,0),btVector3(0,0,0))
+	{
+	}
+};
+
+///same as the BridgeTriangleRaycastCallback of btCollisionWorld::rayTestSingle for btBvhTriangleMeshShape
+struct btPacketTriangleRaycastCallback : public btTriangleRaycastCallback
+{
+	btCollisionWorld::RayResultCallback*	m_resultCallback;
+	btCollisionObject*	m_collisionObject;
+	btTransform	m_colObjWorldTransform;
+
+	btPacketTriangleRaycastCallback()
+		:btTriangleRaycastCallback(btVector3(0,0,0),btVector3(0,0,0)),
+		m_resultCallback(0),
+		m_collisionObject(0)
+	{
+	}
+
+	virtual btScalar reportHit(const btVector3& hitNormalLocal, btScalar hitFraction, int partId, int triangleIndex )
+	{
+		btCollisionWorld::LocalShapeInfo	shapeInfo;
+		shapeInfo.m_shapePart = partId;
+		shapeInfo.m_triangleIndex = triangleIndex;
+
+		btVector3 hitNormalWorld = m_colObjWorldTransform.getBasis() * hitNormalLocal;
+
+		btCollisionWorld::LocalRayResult rayResult
+			(m_collisionObject,
+			&shapeInfo,
+			hitNormalWorld,
+			hitFraction);
+
+		bool	normalInWorldSpace = true;
+		return m_resultCallback->addSingleResult(rayResult,normalInWorldSpace);
+	}
+};
+
+btBatchedRaycaster::btBatchedRaycaster(const btCollisionWorld* world)
+:m_world(world),
+m_sortRays(true)
+{
+}
+
+btBatchedRaycaster::~btBatchedRaycaster()
+{
+}
+
+void	btBatchedRaycaster::clearRays()
+{
+	m_rayFrom.resize(0);
+	m_rayTo.resize(0);
+}
+
+void	btBatchedRaycaster::addRay(const btVector3& rayFromWorld, const btVector3& rayToWorld)
+{
+	m_rayFrom.push_back(rayFromWorld);
+	m_rayTo.push_back(rayToWorld);
+}
+
+void	btBatchedRaycaster::prepareBatch()
+{
+	int numRays = getNumRays();
+	m_results.resize(numRays);
+	m_rayOrder.resize(numRays);
+	if (!numRays)
+		return;
+
+	btVector3 midMin = (m_rayFrom[0]+m_rayTo[0])*btScalar(0.5);
+	btVector3 midMax = midMin;
+	int ray;
+	for (ray=0;ray<numRays;ray++)
+	{
+		btVector3 mid = (m_rayFrom[ray]+m_rayTo[ray])*btScalar(0.5);
+		midMin.setMin(mid);
+		midMax.setMax(mid);
+	}
+	btVector3 extent = midMax-midMin;
+	btVector3 scale;
+	for (int axis=0;axis<3;axis++)
+		scale[axis] = extent[axis] > SIMD_EPSILON ? btScalar((1<<BT_RAY_SORT_BITS)-1) / extent[axis] : btScalar(0.);
+
+	for (ray=0;ray<numRays;ray++)
+	{
+		btRaySortKey& key = m_rayOrder[ray];
+		key.m_ray = ray;
+		key.m_key = 0;
+		if (!m_sortRays)
+			continue;
+		///rays of one octant share the signs of the slab tests, within it they are ordered along a Morton curve through their midpoints
+		btVector3 direction = m_rayTo[ray]-m_rayFrom[ray];
+		btVector3 cell = ((m_rayFrom[ray]+m_rayTo[ray])*btScalar(0.5)-midMin)*scale;
+		unsigned int octant = (direction.getX() < btScalar(0.) ? 4 : 0) | (direction.getY() < btScalar(0.) ? 2 : 0) | (direction.getZ() < btScalar(0.) ? 1 : 0);
+		key.m_key = (octant << (3*BT_RAY_SORT_BITS)) |
+			(btSpreadBits((unsigned int)cell.getX()) << 2) |
+			(btSpreadBits((unsigned int)cell.getY()) << 1) |
+			btSpreadBits((unsigned int)cell.getZ());
+	}
+	if (m_sortRays)
+		m_rayOrder.quickSort(btRaySortPredicate());
+}
+
+void	btBatchedRaycaster::performBatchRaycast()
+{
+	prepareBatch();
+	castPackets(0,getNumPackets());
+}
+
+void	btBatchedRaycaster::castPackets(int firstPacket, int lastPacket)
+{
+	///one stack per call, so that threads casting different ranges share nothing
+	btAlignedObjectArray<btPacketStackEntry> stack;
+	for (int packet=firstPacket;packet<lastPacket;packet++)
+	{
+		castPacket(packet,stack);
+	}
+}
+
+void	btBatchedRaycaster::castPacket(int packet, btAlignedObjectArray<btPacketStackEntry>& stack)
+{
+	int firstRay = packet*BT_RAY_PACKET_SIZE;
+	int numRays = btMin(BT_RAY_PACKET_SIZE,m_rayOrder.size()-firstRay);
+
+	btVector3 rayFrom[BT_RAY_PACKET_SIZE];
+	btVector3 rayTo[BT_RAY_PACKET_SIZE];
+	btTransform rayFromTrans[BT_RAY_PACKET_SIZE];
+	btTransform rayToTrans[BT_RAY_PACKET_SIZE];
+	btPacketRayResultCallback resultCallbacks[BT_RAY_PACKET_SIZE];
+	int lane;
+	for (lane=0;lane<numRays;lane++)
+	{
+		int ray = m_rayOrder[firstRay+lane].m_ray;
+		rayFrom[lane] = m_rayFrom[ray];
+		rayTo[lane] = m_rayTo[ray];
+		rayFromTrans[lane].setIdentity();
+		rayFromTrans[lane].setOrigin(rayFrom[lane]);
+		rayToTrans[lane].setIdentity();
+		rayToTrans[lane].setOrigin(rayTo[lane]);
+		resultCallbacks[lane].m_rayFromWorld = rayFrom[lane];
+		resultCallbacks[lane].m_rayToWorld = rayTo[lane];
+	}
+
+	const btDbvtBroadphase* accelerator = m_world->getBroadphase()->getRaycastAccelerator();
+	if (accelerator)
+	{
+		btRayPacket rayPacket;
+		rayPacket.init(rayFrom,rayTo,numRays);
+		const unsigned int allRays = (1u<<numRays)-1;
+
+		///same sets and node order as btDbvtBroadphase::rayTest, so every ray meets the objects in the same order
+		for (int set=0;set<2;set++)
+		{
+			if (!accelerator->m_sets[set].m_root)
+				continue;
+			stack.resize(0);
+			btPacketStackEntry root;
+			root.m_node = accelerator->m_sets[set].m_root;
+			root.m_rayMask = allRays;
+			stack.push_back(root);
+			while (stack.size())
+			{
+				btPacketStackEntry entry = stack[stack.size()-1];
+				stack.pop_back();
+				unsigned int rayMask = rayPacket.testAabb(entry.m_node->volume.Mins(),entry.m_node->volume.Maxs()) & entry.m_rayMask;
+				if (!rayMask)
+					continue;
+				if (entry.m_node->isinternal())
+				{
+					btPacketStackEntry child;
+					child.m_rayMask = rayMask;
+					child.m_node = entry.m_node->childs[0];
+					stack.push_back(child);
+					child.m_node = entry.m_node->childs[1];
+					stack.push_back(child);
+					continue;
+				}
+
+				btCollisionObject* collisionObject = (btCollisionObject*)((btBroadphaseProxy*)entry.m_node->data)->m_clientObject;
+				const btCollisionShape* collisionShape = collisionObject->getCollisionShape();
+				const btTransform& colObjWorldTransform = collisionObject->getWorldTransform();
+
+				///terminate further ray tests of a ray once its closestHitFraction reached zero, and filter like btSingleRayCallback
+				for (lane=0;lane<numRays;lane++)
+				{
+					if ((rayMask & (1<<lane)) && (resultCallbacks[lane].m_closestHitFraction == btScalar(0.f) ||
+						!resultCallbacks[lane].needsCollision(collisionObject->getBroadphaseHandle())))
+						rayMask &= ~(1<<lane);
+				}
+				if (!rayMask)
+					continue;
+
+				if (collisionShape->getShapeType()==TRIANGLE_MESH_SHAPE_PROXYTYPE)
+				{
+					///all rays that reach the mesh walk its bvh together
+					btBvhTriangleMeshShape* triangleMesh = (btBvhTriangleMeshShape*)collisionShape;
+					btTransform worldTocollisionObject = colObjWorldTransform.inverse();
+					btVector3 rayFromLocal[BT_RAY_PACKET_SIZE];
+					btVector3 rayToLocal[BT_RAY_PACKET_SIZE];
+					btPacketTriangleRaycastCallback triangleCallbacks[BT_RAY_PACKET_SIZE];
+					btTriangleCallback* callbacks[BT_RAY_PACKET_SIZE];
+					int numMeshRays = 0;
+					for (lane=0;lane<numRays;lane++)
+					{
+						if (!(rayMask & (1<<lane)))
+							continue;
+						btPacketTriangleRaycastCallback& rcb = triangleCallbacks[numMeshRays];
+						rayFromLocal[numMeshRays] = worldTocollisionObject * rayFrom[lane];
+						rayToLocal[numMeshRays] = worldTocollisionObject * rayTo[lane];
+						rcb.m_from = rayFromLocal[numMeshRays];
+						rcb.m_to = rayToLocal[numMeshRays];
+						rcb.m_flags = resultCallbacks[lane].m_flags;
+						rcb.m_hitFraction = resultCallbacks[lane].m_closestHitFraction;
+						rcb.m_resultCallback = &resultCallbacks[lane];
+						rcb.m_collisionObject = collisionObject;
+						rcb.m_colObjWorldTransform = colObjWorldTransform;
+						callbacks[numMeshRays] = &rcb;
+						numMeshRays++;
+					}
+					triangleMesh->performRaycastPacket(callbacks,rayFromLocal,rayToLocal,numMeshRays);
+				} else
+				{
+					for (lane=0;lane<numRays;lane++)
+					{
+						if (rayMask & (1<<lane))
+							btCollisionWorld::rayTestSingle(rayFromTrans[lane],rayToTrans[lane],collisionObject,collisionShape,colObjWorldTransform,resultCallbacks[lane]);
+					}
+				}
+			}
+		}
+	} else
+	{
+		for (lane=0;lane<numRays;lane++)
+		{
+			m_world->rayTest(rayFrom[lane],rayTo[lane],resultCallbacks[lane]);
+		}
+	}
+
+	for (lane=0;lane<numRays;lane++)
+	{
+		btBatchedRayResult& result = m_results[m_rayOrder[firstRay+lane].m_ray];
+		result.m_hitFraction = resultCallbacks[lane].m_closestHitFraction;
+		result.m_collisionObject = resultCallbacks[lane].m_collisionObject;
+		if (result.hasHit())
+		{
+			result.m_hitNormalWorld = resultCallbacks[lane].m_hitNormalWorld;
+			result.m_hitPointWorld = resultCallbacks[lane].m_hitPointWorld;
+		} else
+		{
+			result.m_hitNormalWorld.setValue(0,0,0);
+			result.m_hitPointWorld = rayTo[lane];
+		}
+	}
+}
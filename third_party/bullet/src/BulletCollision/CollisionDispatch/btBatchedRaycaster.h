@@ -0,0 +1,124 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2009 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_BATCHED_RAYCASTER_H
+#define BT_BATCHED_RAYCASTER_H
+
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "BulletCollision/BroadphaseCollision/btRayPacket.h"
+
+class btCollisionWorld;
+class btCollisionObject;
+struct btDbvtNode;
+
+///btBatchedRayResult is the closest hit of one ray, with the values of btCollisionWorld::ClosestRayResultCallback
+struct btBatchedRayResult
+{
+	btVector3	m_hitNormalWorld;
+	btVector3	m_hitPointWorld;
+	///1 if the ray hit nothing
+	btScalar	m_hitFraction;
+	const btCollisionObject*	m_collisionObject;
+
+	bool	hasHit() const
+	{
+		return m_collisionObject != 0;
+	}
+};
+
+///btBatchedRaycaster finds the closest hit of many rays in a btCollisionWorld at once.
+///The rays are sorted by direction octant and position, so that neighbouring rays take similar paths, and cast in packets of
+///BT_RAY_PACKET_SIZE rays. A packet walks the btDbvt of the broadphase and the btQuantizedBvh of btBvhTriangleMeshShape objects once
+///for all of its rays, with SIMD box tests. Each ray gets the same result as btCollisionWorld::rayTest with a ClosestRayResultCallback.
+///Broadphases without a btDbvt fall back to one btCollisionWorld::rayTest per ray.
+class btBatchedRaycaster
+{
+protected:
+
+	struct	btRaySortKey
+	{
+		unsigned int	m_key;
+		int				m_ray;
+	};
+
+	///a btDbvt node that is still to be tested against the rays in m_rayMask
+	struct	btPacketStackEntry
+	{
+		const btDbvtNode*	m_node;
+		unsigned int		m_rayMask;
+	};
+
+	const btCollisionWorld*	m_world;
+
+	btAlignedObjectArray<btVector3>	m_rayFrom;
+	btAlignedObjectArray<btVector3>	m_rayTo;
+	btAlignedObjectArray<btBatchedRayResult>	m_results;
+
+	///rays in the order in which they are grouped into packets
+	btAlignedObjectArray<btRaySortKey>	m_rayOrder;
+
+	bool	m_sortRays;
+
+	///sort the rays into packets, called by performBatchRaycast before the packets are cast
+	void	prepareBatch();
+
+	void	castPacket(int packet, btAlignedObjectArray<btPacketStackEntry>& stack);
+
+public:
+
+	btBatchedRaycaster(const btCollisionWorld* world);
+
+	virtual ~btBatchedRaycaster();
+
+	void	clearRays();
+
+	void	addRay(const btVector3& rayFromWorld, const btVector3& rayToWorld);
+
+	int		getNumRays() const
+	{
+		return m_rayFrom.size();
+	}
+
+	///result of the ray with the given index in the order of addRay, valid after performBatchRaycast
+	const btBatchedRayResult&	operator[](int ray) const
+	{
+		return m_results[ray];
+	}
+
+	///sorting makes packets more coherent, disable it if the rays are added in a coherent order already
+	void	setSortRays(bool sortRays)
+	{
+		m_sortRays = sortRays;
+	}
+
+	bool	getSortRays() const
+	{
+		return m_sortRays;
+	}
+
+	virtual void	performBatchRaycast();
+
+	///number of packets of the last performBatchRaycast
+	int		getNumPackets() const
+	{
+		return (m_rayOrder.size() + BT_RAY_PACKET_SIZE - 1) / BT_RAY_PACKET_SIZE;
+	}
+
+	///castPackets casts the packets [firstPacket,lastPacket), it can be called from several threads for disjoint ranges
+	void	castPackets(int firstPacket, int lastPacket);
+};
+
+#endif //BT_BATCHED_RAYCASTER_H
@@ -159,6 +159,79 @@ void	btBvhTriangleMeshShape::performRaycast (btTriangleCallback* callback, const
 	m_bvh->reportRayOverlappingNodex(&myNodeCallback,raySource,rayTarget);
 }
 
+void	btBvhTriangleMeshShape::performRaycastPacket (btTriangleCallback** callbacks, const btVector3* raySource, const btVector3* rayTarget, int numRays)
+{
+	struct	MyNodePacketOverlapCallback : public btNodePacketOverlapCallback
+	{
+		btStridingMeshInterface*	m_meshInterface;
+		btTriangleCallback** m_callbacks;
+
+		MyNodePacketOverlapCallback(btTriangleCallback** callbacks,btStridingMeshInterface* meshInterface)
+			:m_meshInterface(meshInterface),
+			m_callbacks(callbacks)
+		{
+		}
+
+		virtual void processNode(int nodeSubPart, int nodeTriangleIndex, unsigned int rayMask)
+		{
+			btVector3 m_triangle[3];
+			const unsigned char *vertexbase;
+			int numverts;
+			PHY_ScalarType type;
+			int stride;
+			const unsigned char *indexbase;
+			int indexstride;
+			int numfaces;
+			PHY_ScalarType indicestype;
+
+			m_meshInterface->getLockedReadOnlyVertexIndexBase(
+				&vertexbase,
+				numverts,
+				type,
+				stride,
+				&indexbase,
+				indexstride,
+				numfaces,
+				indicestype,
+				nodeSubPart);
+
+			unsigned int* gfxbase = (unsigned int*)(indexbase+nodeTriangleIndex*indexstride);
+			btAssert(indicestype==PHY_INTEGER||indicestype==PHY_SHORT);
+
+			const btVector3& meshScaling = m_meshInterface->getScaling();
+			for (int j=2;j>=0;j--)
+			{
+				int graphicsindex = indicestype==PHY_SHORT?((unsigned short*)gfxbase)[j]:gfxbase[j];
+
+				if (type == PHY_FLOAT)
+				{
+					float* graphicsbase = (float*)(vertexbase+graphicsindex*stride);
+
+					m_triangle[j] = btVector3(graphicsbase[0]*meshScaling.getX(),graphicsbase[1]*meshScaling.getY(),graphicsbase[2]*meshScaling.getZ());
+				}
+				else
+				{
+					double* graphicsbase = (double*)(vertexbase+graphicsindex*stride);
+
+					m_triangle[j] = btVector3(btScalar(graphicsbase[0])*meshScaling.getX(),btScalar(graphicsbase[1])*meshScaling.getY(),btScalar(graphicsbase[2])*meshScaling.getZ());
+				}
+			}
+
+			/* The triangle is fetched once and tested against every ray of the packet that reached it */
+			for (int ray=0;rayMask;ray++,rayMask>>=1)
+			{
+				if (rayMask & 1)
+					m_callbacks[ray]->processTriangle(m_triangle,nodeSubPart,nodeTriangleIndex);
+			}
+			m_meshInterface->unLockReadOnlyVertexBase(nodeSubPart);
+		}
+	};
+
+	MyNodePacketOverlapCallback	myNodeCallback(callbacks,m_meshInterface);
+
+	m_bvh->reportRayPacketOverlappingNodex(&myNodeCallback,raySource,rayTarget,numRays);
+}
+
 void	btBvhTriangleMeshShape::performConvexcast (btTriangleCallback* callback, const btVector3& raySource, const btVector3& rayTarget, const btVector3& aabbMin, const btVector3& aabbMax)
 {
 	struct	MyNodeOverlapCallback : public btNodeOverlapCallback
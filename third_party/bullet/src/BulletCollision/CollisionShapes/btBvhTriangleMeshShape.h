@@ -55,6 +55,8 @@ public:
 
 	
 	void performRaycast (btTriangleCallback* callback, const btVector3& raySource, const btVector3& rayTarget);
+	///performRaycastPacket casts up to BT_RAY_PACKET_SIZE rays with one walk of the bvh, callbacks[i] receives the triangles of ray i
+	void performRaycastPacket (btTriangleCallback** callbacks, const btVector3* raySource, const btVector3* rayTarget, int numRays);
 	void performConvexcast (btTriangleCallback* callback, const btVector3& boxSource, const btVector3& boxTarget, const btVector3& boxMin, const btVector3& boxMax);
 
 	virtual void	processAllTriangles(btTriangleCallback* callback,const btVector3& aabbMin,const btVector3& aabbMax) const;
@@ -61,12 +61,17 @@ public:
 
                 pthread_t thread;
                 sem_t* startSemaphore;
+                sem_t* mainSemaphore;
 
         unsigned long threadUsed;
 	};
 private:
 
 	btAlignedObjectArray<btSpuStatus>	m_activeSpuStatus;
+
+	///signals if and how many threads are finished with their work. Every instance has its own,
+	///so that a collision and a solver thread support can be used next to each other.
+	sem_t*	m_mainSemaphore;
 public:
 	///Setup and initialize SPU/CELL/Libspe2
 
@@ -74,7 +79,7 @@ public:
 
 	struct	ThreadConstructionInfo
 	{
-		ThreadConstructionInfo(char* uniqueName,
+		ThreadConstructionInfo(const char* uniqueName,
 									PosixThreadFunc userThreadFunc,
 									PosixlsMemorySetupFunc	lsMemoryFunc,
 									int numThreads=1,
@@ -89,7 +94,7 @@ public:
 
 		}
 
-		char*					m_uniqueName;
+		const char*				m_uniqueName;
 		PosixThreadFunc			m_userThreadFunc;
 		PosixlsMemorySetupFunc	m_lsMemoryFunc;
 		int						m_numThreads;
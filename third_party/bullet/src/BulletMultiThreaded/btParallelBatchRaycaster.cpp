@@ -0,0 +1,72 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2009 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btParallelBatchRaycaster.h"
+#include "btThreadSupportInterface.h"
+
+
+void	BatchRaycastThreadFunc(void* userPtr,void* lsMemory)
+{
+	(void)lsMemory;
+	btBatchRaycastTaskIO* io = (btBatchRaycastTaskIO*)userPtr;
+	io->m_raycaster->castPackets(io->m_firstPacket,io->m_lastPacket);
+}
+
+void*	BatchRaycastlsMemoryFunc()
+{
+	//don't create local store memory, just return 0
+	return 0;
+}
+
+
+btParallelBatchRaycaster::btParallelBatchRaycaster(const btCollisionWorld* world, btThreadSupportInterface* threadSupport)
+:btBatchedRaycaster(world),
+m_threadSupport(threadSupport)
+{
+	m_taskIO.resize(m_threadSupport->getNumTasks());
+}
+
+btParallelBatchRaycaster::~btParallelBatchRaycaster()
+{
+}
+
+void	btParallelBatchRaycaster::performBatchRaycast()
+{
+	prepareBatch();
+
+	int numPackets = getNumPackets();
+	int numTasks = btMin(m_taskIO.size(),numPackets);
+	if (numTasks <= 1)
+	{
+		castPackets(0,numPackets);
+		return;
+	}
+
+	int t;
+	for (t=0;t<numTasks;t++)
+	{
+		btBatchRaycastTaskIO& io = m_taskIO[t];
+		io.m_raycaster = this;
+		io.m_firstPacket = numPackets*t/numTasks;
+		io.m_lastPacket = numPackets*(t+1)/numTasks;
+		///command 1 is the generic 'run the task function' request of the thread supports
+		m_threadSupport->sendRequest(1,(ppu_address_t)&io,t);
+	}
+	unsigned int arg0,arg1;
+	for (t=0;t<numTasks;t++)
+	{
+		m_threadSupport->waitForResponse(&arg0,&arg1);
+	}
+}
@@ -0,0 +1,54 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2009 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_PARALLEL_BATCH_RAYCASTER_H
+#define BT_PARALLEL_BATCH_RAYCASTER_H
+
+#include "BulletCollision/CollisionDispatch/btBatchedRaycaster.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btThreadSupportInterface;
+
+///work of one task: the packets [m_firstPacket,m_lastPacket) of m_raycaster
+struct btBatchRaycastTaskIO
+{
+	btBatchedRaycaster*	m_raycaster;
+	int					m_firstPacket;
+	int					m_lastPacket;
+};
+
+void	BatchRaycastThreadFunc(void* userPtr,void* lsMemory);
+void*	BatchRaycastlsMemoryFunc();
+
+///btParallelBatchRaycaster splits the sorted packets of a btBatchedRaycaster into one contiguous range per task,
+///so neighbouring packets that share nodes of the trees stay on the same thread
+class btParallelBatchRaycaster : public btBatchedRaycaster
+{
+protected:
+
+	btThreadSupportInterface*	m_threadSupport;
+
+	btAlignedObjectArray<btBatchRaycastTaskIO>	m_taskIO;
+
+public:
+
+	btParallelBatchRaycaster(const btCollisionWorld* world, btThreadSupportInterface* threadSupport);
+
+	virtual ~btParallelBatchRaycaster();
+
+	virtual void	performBatchRaycast();
+};
+
+#endif //BT_PARALLEL_BATCH_RAYCASTER_H
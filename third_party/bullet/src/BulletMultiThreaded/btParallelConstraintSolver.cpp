@@ -1001,7 +1001,9 @@ btParallelConstraintSolver::btParallelConstraintSolver(btThreadSupportInterface*
 btParallelConstraintSolver::~btParallelConstraintSolver()
 {
 	delete m_memoryCache;
-	delete m_solverIO;
+	delete [] m_solverIO;
+	delete m_criticalSection;
+	delete m_barrier;
 }
 
 
@@ -20,6 +20,11 @@
 
 static btClock gProfileClock;
 
+#ifdef BT_WASM_PERF_PROFILE
+bool gWasmPerfProfile = false;
+unsigned long long gWasmPerfProfileSamples = 0;
+#endif //BT_WASM_PERF_PROFILE
+
 
 #ifdef __CELLOS_LV2__
 #include <sys/sys_time.h>
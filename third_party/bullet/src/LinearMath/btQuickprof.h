@@ -23,6 +23,15 @@
 #include "btAlignedAllocator.h"
 #include <new>
 
+#ifdef BT_WASM_PERF_PROFILE
+#include "wasm_perf.h"
+
+///When set, every BT_PROFILE scope is also recorded as a wasm_perf interval named after the scope.
+///Nested scopes produce nested intervals.
+extern bool gWasmPerfProfile;
+extern unsigned long long gWasmPerfProfileSamples;
+#endif //BT_WASM_PERF_PROFILE
+
 
 
 
@@ -172,12 +181,30 @@ public:
 	CProfileSample( const char * name )
 	{ 
 		CProfileManager::Start_Profile( name ); 
+#ifdef BT_WASM_PERF_PROFILE
+		m_name = gWasmPerfProfile ? name : 0;
+		if (m_name)
+		{
+			m_reference = gWasmPerfProfileSamples++;
+			wasm_perf_mark_begin(m_name, m_reference);
+		}
+#endif //BT_WASM_PERF_PROFILE
 	}
 
 	~CProfileSample( void )					
 	{ 
+#ifdef BT_WASM_PERF_PROFILE
+		if (m_name)
+			wasm_perf_mark_end(m_name, m_reference);
+#endif //BT_WASM_PERF_PROFILE
 		CProfileManager::Stop_Profile(); 
 	}
+
+#ifdef BT_WASM_PERF_PROFILE
+private:
+	const char *	m_name;
+	unsigned long long	m_reference;
+#endif //BT_WASM_PERF_PROFILE
 };
 
 
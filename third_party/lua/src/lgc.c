@@ -1156,11 +1156,13 @@ static void incstep (lua_State *L) {
 void luaC_forcestep (lua_State *L) {
   global_State *g = G(L);
   int i;
+  luai_gcstepbegin(L);
   if (isgenerational(g)) generationalcollection(L);
   else incstep(L);
   /* run a few finalizers (or all of them at the end of a collect cycle) */
   for (i = 0; g->tobefnz && (i < GCFINALIZENUM || g->gcstate == GCSpause); i++)
     GCTM(L, 1);  /* call one finalizer */
+  luai_gcstepend(L);
 }
 
 
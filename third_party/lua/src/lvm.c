@@ -527,15 +527,58 @@ void luaV_finishOp (lua_State *L) {
         else { Protect(luaV_arith(L, ra, rb, rc, tm)); } }
 
 
+/* fetch the next instruction and run hooks before executing it */
+#define vmfetch() { \
+    i = *(ci->u.l.savedpc++); \
+    if ((L->hookmask & (LUA_MASKLINE | LUA_MASKCOUNT)) && \
+        (--L->hookcount == 0 || L->hookmask & LUA_MASKLINE)) { \
+      Protect(traceexec(L)); \
+    } \
+    /* WARNING: several calls may realloc the stack and invalidate `ra' */ \
+    ra = RA(i); \
+    lua_assert(base == ci->u.l.base); \
+    lua_assert(base <= L->top && L->top < L->stack + L->stacksize); \
+  }
+
+/*
+** LUA_USE_COMPUTED_GOTO replaces the switch by direct threading: every
+** opcode fetches the next instruction itself and jumps through a table of
+** label addresses, which saves the bounds check and gives each opcode its
+** own indirect jump. Needs the GCC "labels as values" extension.
+*/
+#if defined(LUA_USE_COMPUTED_GOTO) && defined(__GNUC__)
+#define vmdispatch(o)	goto *disptab[o];
+#define vmcase(l,b)	L_##l: {b}  vmfetch(); vmdispatch(GET_OPCODE(i))
+#define vmcasenb(l,b)	L_##l: {b}		/* nb = no break */
+#else
+#undef LUA_USE_COMPUTED_GOTO
 #define vmdispatch(o)	switch(o)
 #define vmcase(l,b)	case l: {b}  break;
 #define vmcasenb(l,b)	case l: {b}		/* nb = no break */
+#endif
 
 void luaV_execute (lua_State *L) {
   CallInfo *ci = L->ci;
   LClosure *cl;
   TValue *k;
   StkId base;
+  Instruction i;
+  StkId ra;
+#if defined(LUA_USE_COMPUTED_GOTO)
+  /* must follow the order of OpCode in lopcodes.h */
+  static const void *const disptab[NUM_OPCODES] = {
+    &&L_OP_MOVE, &&L_OP_LOADK, &&L_OP_LOADKX, &&L_OP_LOADBOOL,
+    &&L_OP_LOADNIL, &&L_OP_GETUPVAL, &&L_OP_GETTABUP, &&L_OP_GETTABLE,
+    &&L_OP_SETTABUP, &&L_OP_SETUPVAL, &&L_OP_SETTABLE, &&L_OP_NEWTABLE,
+    &&L_OP_SELF, &&L_OP_ADD, &&L_OP_SUB, &&L_OP_MUL, &&L_OP_DIV,
+    &&L_OP_MOD, &&L_OP_POW, &&L_OP_UNM, &&L_OP_NOT, &&L_OP_LEN,
+    &&L_OP_CONCAT, &&L_OP_JMP, &&L_OP_EQ, &&L_OP_LT, &&L_OP_LE,
+    &&L_OP_TEST, &&L_OP_TESTSET, &&L_OP_CALL, &&L_OP_TAILCALL,
+    &&L_OP_RETURN, &&L_OP_FORLOOP, &&L_OP_FORPREP, &&L_OP_TFORCALL,
+    &&L_OP_TFORLOOP, &&L_OP_SETLIST, &&L_OP_CLOSURE, &&L_OP_VARARG,
+    &&L_OP_EXTRAARG
+  };
+#endif
  newframe:  /* reentry point when frame changes (call/return) */
   lua_assert(ci == L->ci);
   cl = clLvalue(ci->func);
@@ -543,16 +586,7 @@ void luaV_execute (lua_State *L) {
   base = ci->u.l.base;
   /* main loop of interpreter */
   for (;;) {
-    Instruction i = *(ci->u.l.savedpc++);
-    StkId ra;
-    if ((L->hookmask & (LUA_MASKLINE | LUA_MASKCOUNT)) &&
-        (--L->hookcount == 0 || L->hookmask & LUA_MASKLINE)) {
-      Protect(traceexec(L));
-    }
-    /* WARNING: several calls may realloc the stack and invalidate `ra' */
-    ra = RA(i);
-    lua_assert(base == ci->u.l.base);
-    lua_assert(base <= L->top && L->top < L->stack + L->stacksize);
+    vmfetch();
     vmdispatch (GET_OPCODE(i)) {
       vmcase(OP_MOVE,
         setobjs2s(L, ra, RB(i));
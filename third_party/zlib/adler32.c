@@ -6,6 +6,7 @@
 /* @(#) $Id$ */
 
 #include "zutil.h"
+#include "adler32_simd.h"
 
 #define local static
 
@@ -84,6 +85,24 @@ uLong ZEXPORT adler32(adler, buf, len)
     if (buf == Z_NULL)
         return 1L;
 
+#if defined(X86_SIMD_CHECKSUMS) || defined(WASM_SIMD_CHECKSUMS)
+    /* long enough buffers go to the widest SIMD version the CPU supports */
+    if (len >= ADLER32_SIMD_MIN_LEN) {
+        unsigned features = zlibCpuFeatures();
+
+#ifdef X86_SIMD_CHECKSUMS
+        if (features & Z_CPU_AVX2)
+            return adler32_avx2(adler | (sum2 << 16), buf, len);
+        if (features & Z_CPU_SSSE3)
+            return adler32_ssse3(adler | (sum2 << 16), buf, len);
+#endif
+#ifdef WASM_SIMD_CHECKSUMS
+        if (features & Z_CPU_SIMD128)
+            return adler32_simd128(adler | (sum2 << 16), buf, len);
+#endif
+    }
+#endif
+
     /* in case short lengths are provided, keep it somewhat fast */
     if (len < 16) {
         while (len--) {
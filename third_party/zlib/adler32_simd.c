@@ -0,0 +1,225 @@
+/* adler32_simd.c -- compute the Adler-32 checksum of a data stream with SIMD
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * The data is summed in blocks of 32 bytes (SSSE3, simd128) or 64 bytes
+ * (AVX2). For each block, adler gets the sum of its bytes and sum2 gets the
+ * bytes weighted by their distance from the end of the block, plus the block
+ * size times adler before the block. The vector lanes are added up and reduced
+ * modulo BASE after as many bytes as adler32() sums without a modulo.
+ */
+
+/* @(#) $Id$ */
+
+#include "zutil.h"
+#include "adler32_simd.h"
+
+#ifdef X86_SIMD_CHECKSUMS
+#  include <immintrin.h>
+#endif
+#ifdef WASM_SIMD_CHECKSUMS
+#  include <wasm_simd128.h>
+#endif
+
+#define local static
+
+#define BASE 65521UL    /* largest prime smaller than 65536 */
+#define NMAX 5552
+/* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
+
+/* sum the bytes that are left after the last whole block */
+#define TAIL(adler, sum2, buf, len) \
+    do { \
+        while (len--) { \
+            adler += *buf++; \
+            sum2 += adler; \
+        } \
+        adler %= BASE; \
+        sum2 %= BASE; \
+    } while (0)
+
+#ifdef X86_SIMD_CHECKSUMS
+
+/* ========================================================================= */
+__attribute__((target("ssse3")))
+uLong ZLIB_INTERNAL adler32_ssse3(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned long sum2 = (adler >> 16) & 0xffff;
+    unsigned blocks = len / 32;
+
+    adler &= 0xffff;
+    len -= blocks * 32;
+    while (blocks) {
+        const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                           24, 23, 22, 21, 20, 19, 18, 17);
+        const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                           8, 7, 6, 5, 4, 3, 2, 1);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi16(1);
+        unsigned n = NMAX / 32;
+        __m128i v_ps, v_s1, v_s2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        /* v_ps sums adler before each block, times 32 at the end */
+        v_ps = _mm_setr_epi32((int)(adler * n), 0, 0, 0);
+        v_s1 = _mm_setzero_si128();
+        v_s2 = _mm_setr_epi32((int)sum2, 0, 0, 0);
+        do {
+            const __m128i bytes1 = _mm_loadu_si128((const __m128i *)buf);
+            const __m128i bytes2 = _mm_loadu_si128((const __m128i *)(buf + 16));
+
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2,
+                _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2,
+                _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            buf += 32;
+        } while (--n);
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        adler = (adler + (unsigned)_mm_cvtsi128_si32(v_s1)) % BASE;
+        sum2 = (unsigned)_mm_cvtsi128_si32(v_s2) % BASE;
+    }
+    TAIL(adler, sum2, buf, len);
+    return adler | (sum2 << 16);
+}
+
+/* ========================================================================= */
+__attribute__((target("avx2")))
+uLong ZLIB_INTERNAL adler32_avx2(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned long sum2 = (adler >> 16) & 0xffff;
+    unsigned blocks = len / 64;
+
+    adler &= 0xffff;
+    len -= blocks * 64;
+    while (blocks) {
+        const __m256i tap1 = _mm256_setr_epi8(64, 63, 62, 61, 60, 59, 58, 57,
+            56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41,
+            40, 39, 38, 37, 36, 35, 34, 33);
+        const __m256i tap2 = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+            24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9,
+            8, 7, 6, 5, 4, 3, 2, 1);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i ones = _mm256_set1_epi16(1);
+        unsigned n = NMAX / 64;
+        __m256i v_ps, v_s1, v_s2;
+        __m128i h_s1, h_s2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        /* v_ps sums adler before each block, times 64 at the end */
+        v_ps = _mm256_setr_epi32((int)(adler * n), 0, 0, 0, 0, 0, 0, 0);
+        v_s1 = _mm256_setzero_si256();
+        v_s2 = _mm256_setr_epi32((int)sum2, 0, 0, 0, 0, 0, 0, 0);
+        do {
+            const __m256i bytes1 = _mm256_loadu_si256((const __m256i *)buf);
+            const __m256i bytes2 = _mm256_loadu_si256((const __m256i *)(buf + 32));
+
+            v_ps = _mm256_add_epi32(v_ps, v_s1);
+            v_s1 = _mm256_add_epi32(v_s1, _mm256_add_epi32(
+                _mm256_sad_epu8(bytes1, zero), _mm256_sad_epu8(bytes2, zero)));
+            v_s2 = _mm256_add_epi32(v_s2, _mm256_add_epi32(
+                _mm256_madd_epi16(_mm256_maddubs_epi16(bytes1, tap1), ones),
+                _mm256_madd_epi16(_mm256_maddubs_epi16(bytes2, tap2), ones)));
+            buf += 64;
+        } while (--n);
+        v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 6));
+
+        h_s1 = _mm_add_epi32(_mm256_castsi256_si128(v_s1),
+                             _mm256_extracti128_si256(v_s1, 1));
+        h_s2 = _mm_add_epi32(_mm256_castsi256_si128(v_s2),
+                             _mm256_extracti128_si256(v_s2, 1));
+        h_s1 = _mm_add_epi32(h_s1, _mm_shuffle_epi32(h_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        h_s1 = _mm_add_epi32(h_s1, _mm_shuffle_epi32(h_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        h_s2 = _mm_add_epi32(h_s2, _mm_shuffle_epi32(h_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        h_s2 = _mm_add_epi32(h_s2, _mm_shuffle_epi32(h_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        adler = (adler + (unsigned)_mm_cvtsi128_si32(h_s1)) % BASE;
+        sum2 = (unsigned)_mm_cvtsi128_si32(h_s2) % BASE;
+    }
+    TAIL(adler, sum2, buf, len);
+    return adler | (sum2 << 16);
+}
+
+#endif /* X86_SIMD_CHECKSUMS */
+
+#ifdef WASM_SIMD_CHECKSUMS
+
+/* ========================================================================= */
+uLong ZLIB_INTERNAL adler32_simd128(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned long sum2 = (adler >> 16) & 0xffff;
+    unsigned blocks = len / 32;
+
+    adler &= 0xffff;
+    len -= blocks * 32;
+    while (blocks) {
+        /* simd128 has no multiply-add of bytes, so the bytes are widened to
+           16 bits for the dot products with the taps */
+        const v128_t tap1 = wasm_i16x8_make(32, 31, 30, 29, 28, 27, 26, 25);
+        const v128_t tap2 = wasm_i16x8_make(24, 23, 22, 21, 20, 19, 18, 17);
+        const v128_t tap3 = wasm_i16x8_make(16, 15, 14, 13, 12, 11, 10, 9);
+        const v128_t tap4 = wasm_i16x8_make(8, 7, 6, 5, 4, 3, 2, 1);
+        unsigned n = NMAX / 32;
+        v128_t v_ps, v_s1, v_s2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        /* v_ps sums adler before each block, times 32 at the end */
+        v_ps = wasm_i32x4_make((int)(adler * n), 0, 0, 0);
+        v_s1 = wasm_i32x4_splat(0);
+        v_s2 = wasm_i32x4_make((int)sum2, 0, 0, 0);
+        do {
+            const v128_t bytes1 = wasm_v128_load(buf);
+            const v128_t bytes2 = wasm_v128_load(buf + 16);
+
+            v_ps = wasm_i32x4_add(v_ps, v_s1);
+            v_s1 = wasm_i32x4_add(v_s1, wasm_u32x4_extadd_pairwise_u16x8(
+                wasm_i16x8_add(wasm_u16x8_extadd_pairwise_u8x16(bytes1),
+                               wasm_u16x8_extadd_pairwise_u8x16(bytes2))));
+            v_s2 = wasm_i32x4_add(v_s2, wasm_i32x4_add(
+                wasm_i32x4_add(
+                    wasm_i32x4_dot_i16x8(wasm_u16x8_extend_low_u8x16(bytes1), tap1),
+                    wasm_i32x4_dot_i16x8(wasm_u16x8_extend_high_u8x16(bytes1), tap2)),
+                wasm_i32x4_add(
+                    wasm_i32x4_dot_i16x8(wasm_u16x8_extend_low_u8x16(bytes2), tap3),
+                    wasm_i32x4_dot_i16x8(wasm_u16x8_extend_high_u8x16(bytes2), tap4))));
+            buf += 32;
+        } while (--n);
+        v_s2 = wasm_i32x4_add(v_s2, wasm_i32x4_shl(v_ps, 5));
+
+        adler = (adler + (unsigned)wasm_i32x4_extract_lane(v_s1, 0) +
+                 (unsigned)wasm_i32x4_extract_lane(v_s1, 1) +
+                 (unsigned)wasm_i32x4_extract_lane(v_s1, 2) +
+                 (unsigned)wasm_i32x4_extract_lane(v_s1, 3)) % BASE;
+        sum2 = ((unsigned)wasm_i32x4_extract_lane(v_s2, 0) +
+                (unsigned)wasm_i32x4_extract_lane(v_s2, 1) +
+                (unsigned)wasm_i32x4_extract_lane(v_s2, 2) +
+                (unsigned)wasm_i32x4_extract_lane(v_s2, 3)) % BASE;
+    }
+    TAIL(adler, sum2, buf, len);
+    return adler | (sum2 << 16);
+}
+
+#endif /* WASM_SIMD_CHECKSUMS */
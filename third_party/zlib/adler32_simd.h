@@ -0,0 +1,29 @@
+/* adler32_simd.h -- SIMD versions of adler32()
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef ADLER32_SIMD_H
+#define ADLER32_SIMD_H
+
+#include "cpu_features.h"
+
+/* adler32() hands buffers of at least this many bytes to the SIMD versions */
+#define ADLER32_SIMD_MIN_LEN 64
+
+#ifdef X86_SIMD_CHECKSUMS
+uLong ZLIB_INTERNAL adler32_ssse3 OF((uLong adler, const Bytef *buf,
+                                      uInt len));
+uLong ZLIB_INTERNAL adler32_avx2 OF((uLong adler, const Bytef *buf,
+                                     uInt len));
+#endif
+#ifdef WASM_SIMD_CHECKSUMS
+uLong ZLIB_INTERNAL adler32_simd128 OF((uLong adler, const Bytef *buf,
+                                        uInt len));
+#endif
+
+#endif /* ADLER32_SIMD_H */
@@ -0,0 +1,74 @@
+/* compare258.c -- compare the strings of deflate's longest_match_wide()
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * This is the only part of FAST_DEFLATE that uses SIMD. It is kept out of
+ * deflate.c so that Emscripten builds can compile it alone with -msimd128,
+ * without auto-vectorizing the rest of deflate, classic longest_match()
+ * included.
+ */
+
+/* @(#) $Id$ */
+
+#include "deflate.h"
+#include "compare258.h"
+
+#ifdef FAST_DEFLATE
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#endif
+
+/* ===========================================================================
+ * Return the number of equal bytes at the start of scan and match, at most
+ * MAX_MATCH. The blocks that are compared can extend up to 15 bytes past
+ * MAX_MATCH, which WIN_PADDING allows for at the end of the window.
+ */
+uInt ZLIB_INTERNAL compare258(scan, match)
+    const Bytef *scan;
+    const Bytef *match;
+{
+    uInt len = 0;
+#if defined(__SSE2__)
+    int mask;
+
+    do {
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *)(scan + len)),
+            _mm_loadu_si128((const __m128i *)(match + len))));
+        if (mask != 0xffff) {
+            len += __builtin_ctz(~mask);
+            break;
+        }
+        len += 16;
+    } while (len < MAX_MATCH);
+#elif defined(__wasm_simd128__)
+    int mask;
+
+    do {
+        mask = wasm_i8x16_bitmask(wasm_i8x16_eq(wasm_v128_load(scan + len),
+                                                wasm_v128_load(match + len)));
+        if (mask != 0xffff) {
+            len += __builtin_ctz(~mask);
+            break;
+        }
+        len += 16;
+    } while (len < MAX_MATCH);
+#else
+    unsigned long long a, b;
+
+    do {
+        zmemcpy(&a, scan + len, sizeof(a));
+        zmemcpy(&b, match + len, sizeof(b));
+        if (a != b) {
+            /* little endian: the first different byte is the lowest one */
+            len += __builtin_ctzll(a ^ b) >> 3;
+            break;
+        }
+        len += 8;
+    } while (len < MAX_MATCH);
+#endif
+    return len < MAX_MATCH ? len : MAX_MATCH;
+}
+#endif /* FAST_DEFLATE */
@@ -0,0 +1,21 @@
+/* compare258.h -- header to use compare258.c
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef COMPARE258_H
+#define COMPARE258_H
+
+#include "cpu_features.h"
+
+#ifdef FAST_DEFLATE
+/* number of equal bytes at the start of scan and match, at most 258. Reads
+   up to 15 bytes past the 258 bytes of both. */
+uInt ZLIB_INTERNAL compare258 OF((const Bytef *scan, const Bytef *match));
+#endif
+
+#endif /* COMPARE258_H */
@@ -0,0 +1,79 @@
+/* cpu_features.c -- detect the SIMD features used by the checksums
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* @(#) $Id$ */
+
+#include "zutil.h"
+#include "cpu_features.h"
+
+#ifdef X86_SIMD_CHECKSUMS
+#  include <cpuid.h>
+#endif
+
+#define local static
+
+/* Detection is idempotent, so threads that race on the first call store
+   the same value.
+ */
+local volatile int features_checked = 0;
+local volatile unsigned features = 0;
+
+local unsigned detect_features OF((void));
+
+/* ========================================================================= */
+local unsigned detect_features()
+{
+    unsigned detected = 0;
+#ifdef X86_SIMD_CHECKSUMS
+    unsigned eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        if (ecx & bit_SSSE3)
+            detected |= Z_CPU_SSSE3;
+        if ((ecx & bit_PCLMUL) && (ecx & bit_SSE4_1))
+            detected |= Z_CPU_PCLMULQDQ;
+
+        /* AVX2 also needs the OS to save the upper halves of the ymm
+           registers, which XCR0 bits 1 and 2 tell */
+        if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+            unsigned xcr0, xcr0_high;
+
+            __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0_high) : "c" (0));
+            if ((xcr0 & 6) == 6 &&
+                __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+                (ebx & bit_AVX2))
+                detected |= Z_CPU_AVX2;
+        }
+    }
+#endif /* X86_SIMD_CHECKSUMS */
+#ifdef WASM_SIMD_CHECKSUMS
+    /* a module that uses simd128 only validates on engines that support it */
+    detected |= Z_CPU_SIMD128;
+#endif /* WASM_SIMD_CHECKSUMS */
+#ifdef FAST_DEFLATE
+    detected |= Z_FAST_DEFLATE;
+#endif
+#ifdef FAST_INFLATE
+    detected |= Z_FAST_INFLATE;
+#endif
+    return detected;
+}
+
+/* ========================================================================= */
+unsigned ZEXPORT zlibCpuFeatures()
+{
+    if (!features_checked) {
+        features = detect_features();
+        features_checked = 1;
+    }
+    return features;
+}
+
+/* ========================================================================= */
+unsigned ZEXPORT zlibRestrictCpuFeatures(mask)
+    unsigned mask;
+{
+    features = zlibCpuFeatures() & mask;
+    return features;
+}
@@ -0,0 +1,76 @@
+/* cpu_features.h -- SIMD features used by the checksums and deflate
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications, except to
+   restrict the features for benchmarks and tests. It is part of the
+   implementation of the compression library and is subject to change.
+ */
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include "zlib.h"
+
+/* x86 builds with GCC or clang detect SSSE3, AVX2 and PCLMULQDQ at run time
+   and compile those functions with target attributes, so that the rest of
+   the library still runs on any x86 CPU. Wasm builds define
+   WASM_SIMD_CHECKSUMS and compile adler32_simd.c with -msimd128.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && \
+    !defined(NO_SIMD_CHECKSUMS)
+#  define X86_SIMD_CHECKSUMS
+#endif
+#if defined(WASM_SIMD_CHECKSUMS) && defined(NO_SIMD_CHECKSUMS)
+#  undef WASM_SIMD_CHECKSUMS
+#endif
+
+/* Little endian builds with GCC or clang define FAST_DEFLATE. deflate() then
+   hashes 4 bytes with a multiplication instead of updating a 3 byte
+   shift-xor hash, and longest_match() compares 16 bytes at a time with SSE2
+   or simd128, or 8 bytes with 64 bit loads. The output is different but
+   still valid deflate data.
+ */
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && \
+    !defined(NO_FAST_DEFLATE) && !defined(FASTEST) && !defined(ASMV)
+#  define FAST_DEFLATE
+#endif
+
+/* The same builds define FAST_INFLATE, and inflate() then decodes with
+   inflate_fast_chunk(), which has a 64 bit bit buffer and copies matches in
+   chunks of 16 bytes with SSE2 or simd128, or 8 bytes otherwise.
+ */
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && \
+    !defined(NO_FAST_INFLATE) && !defined(ASMINF)
+#  define FAST_INFLATE
+#endif
+
+#define Z_CPU_SSSE3     1   /* adler32_ssse3() */
+#define Z_CPU_AVX2      2   /* adler32_avx2() */
+#define Z_CPU_PCLMULQDQ 4   /* crc32_pclmul(), also needs SSE4.1 */
+#define Z_CPU_SIMD128   8   /* adler32_simd128() */
+#define Z_FAST_DEFLATE  16  /* FAST_DEFLATE, not a CPU feature but it can be
+                               turned off the same way */
+#define Z_FAST_INFLATE  32  /* FAST_INFLATE, likewise */
+
+ZEXTERN unsigned ZEXPORT zlibCpuFeatures OF((void));
+/* Return the Z_CPU_* features that adler32() and crc32() use, which are
+   detected on the first call, and Z_FAST_DEFLATE and Z_FAST_INFLATE in
+   FAST_DEFLATE and FAST_INFLATE builds.
+*/
+
+ZEXTERN unsigned ZEXPORT zlibRestrictCpuFeatures OF((unsigned mask));
+/* Stop adler32() and crc32() from using the features that are not in mask,
+   and return the features that are left. Without Z_FAST_DEFLATE, streams
+   that deflateInit() sets up afterwards use the original hash and
+   longest_match(), and without Z_FAST_INFLATE, streams that inflateInit()
+   sets up use inflate_fast(). Features can not be enabled again. Call this
+   before other threads use zlib.
+
+   All features are on by default, so zlibRestrictCpuFeatures(0) is needed
+   to run the original zlib code.
+*/
+
+#endif /* CPU_FEATURES_H */
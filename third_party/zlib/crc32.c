@@ -27,6 +27,7 @@
 #endif /* MAKECRCH */
 
 #include "zutil.h"      /* for STDC and FAR definitions */
+#include "crc32_simd.h"
 
 #define local static
 
@@ -230,6 +231,20 @@ unsigned long ZEXPORT crc32(crc, buf, len)
         make_crc_table();
 #endif /* DYNAMIC_CRC_TABLE */
 
+#ifdef X86_SIMD_CHECKSUMS
+    /* fold the whole 16 byte blocks with PCLMULQDQ, the tables do the rest */
+    if (len >= CRC32_SIMD_MIN_LEN && (zlibCpuFeatures() & Z_CPU_PCLMULQDQ)) {
+        uInt blocks = len & ~15U;
+
+        crc = crc32_pclmul((unsigned)crc ^ 0xffffffffU, buf, blocks) ^
+              0xffffffffUL;
+        buf += blocks;
+        len -= blocks;
+        if (len == 0)
+            return crc;
+    }
+#endif /* X86_SIMD_CHECKSUMS */
+
 #ifdef BYFOUR
     if (sizeof(void *) == sizeof(ptrdiff_t)) {
         u4 endian;
@@ -0,0 +1,117 @@
+/* crc32_simd.c -- compute the CRC-32 of a data stream with PCLMULQDQ
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Folds four 128-bit lanes of the data at a time with carry-less multiplies,
+ * then folds them into one lane and reduces that to 32 bits with a Barrett
+ * reduction, as described in "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction" by Gopal et al. (Intel, 2009). The constants
+ * are the bit-reflected x^n mod P(x) and Barrett constants of the CRC-32
+ * polynomial given at the end of that paper.
+ */
+
+/* @(#) $Id$ */
+
+#include "zutil.h"
+#include "crc32_simd.h"
+
+#ifdef X86_SIMD_CHECKSUMS
+
+#include <immintrin.h>
+
+#define local static
+
+local const unsigned long long k1k2[2] __attribute__((aligned(16))) =
+    { 0x0154442bd4ULL, 0x01c6e41596ULL };
+local const unsigned long long k3k4[2] __attribute__((aligned(16))) =
+    { 0x01751997d0ULL, 0x00ccaa009eULL };
+local const unsigned long long k5k0[2] __attribute__((aligned(16))) =
+    { 0x0163cd6124ULL, 0x0000000000ULL };
+local const unsigned long long poly[2] __attribute__((aligned(16))) =
+    { 0x01db710641ULL, 0x01f7011641ULL };
+
+/* ========================================================================= */
+__attribute__((target("sse4.1,pclmul")))
+unsigned ZLIB_INTERNAL crc32_pclmul(crc, buf, len)
+    unsigned crc;
+    const Bytef *buf;
+    uInt len;
+{
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    /* there is at least one block of 64 bytes */
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+    buf += 64;
+    len -= 64;
+
+    /* fold the four lanes over each following block of 64 bytes */
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+        buf += 64;
+        len -= 64;
+    }
+
+    /* fold the four lanes into one */
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* fold the lane over each remaining block of 16 bytes */
+    while (len >= 16) {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        buf += 16;
+        len -= 16;
+    }
+
+    /* fold 128 bits to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = _mm_load_si128((const __m128i *)poly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (unsigned)_mm_extract_epi32(x1, 1);
+}
+
+#endif /* X86_SIMD_CHECKSUMS */
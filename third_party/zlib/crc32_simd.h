@@ -0,0 +1,25 @@
+/* crc32_simd.h -- SIMD version of crc32()
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef CRC32_SIMD_H
+#define CRC32_SIMD_H
+
+#include "cpu_features.h"
+
+/* crc32() hands buffers of at least this many bytes to crc32_pclmul(), which
+   takes a multiple of 16 bytes */
+#define CRC32_SIMD_MIN_LEN 64
+
+#ifdef X86_SIMD_CHECKSUMS
+/* crc is the inverted register value, as it is between the steps of crc32() */
+unsigned ZLIB_INTERNAL crc32_pclmul OF((unsigned crc, const Bytef *buf,
+                                        uInt len));
+#endif
+
+#endif /* CRC32_SIMD_H */
@@ -50,6 +50,8 @@
 /* @(#) $Id$ */
 
 #include "deflate.h"
+#include "cpu_features.h"
+#include "compare258.h"
 
 const char deflate_copyright[] =
    " deflate 1.2.5 Copyright 1995-2010 Jean-loup Gailly and Mark Adler ";
@@ -91,6 +93,10 @@ local int read_buf        OF((z_streamp strm, Bytef *buf, unsigned size));
 #else
 local uInt longest_match  OF((deflate_state *s, IPos cur_match));
 #endif
+#ifdef FAST_DEFLATE
+local void insert_strings OF((deflate_state *s, uInt str, uInt count));
+local uInt longest_match_wide OF((deflate_state *s, IPos cur_match));
+#endif
 
 #ifdef DEBUG
 local  void check_match OF((deflate_state *s, IPos start, IPos match,
@@ -163,6 +169,32 @@ struct static_tree_desc_s {int dummy;}; /* for buggy compilers */
  */
 #define UPDATE_HASH(s,h,c) (h = (((h)<<s->hash_shift) ^ (c)) & s->hash_mask)
 
+#ifdef FAST_DEFLATE
+/* ===========================================================================
+ * FAST_DEFLATE hash of the 4 bytes at p: the top hash_bits bits of their
+ * product with a golden ratio constant. It spreads the strings over the hash
+ * chains better than UPDATE_HASH and does not depend on the hash of the
+ * previous string, but strings that only share 3 bytes are rarely matched.
+ */
+#define HASH4(s,p) ((load32(p) * 2654435761U) >> (32 - (s)->hash_bits))
+
+local unsigned load32(p)
+    const Bytef *p;
+{
+    unsigned v;
+    zmemcpy(&v, p, sizeof(v));
+    return v;
+}
+
+local ush load16(p)
+    const Bytef *p;
+{
+    ush v;
+    zmemcpy(&v, p, sizeof(v));
+    return v;
+}
+#endif
+
 
 /* ===========================================================================
  * Insert string str in the dictionary and set match_head to the previous head
@@ -179,6 +211,12 @@ struct static_tree_desc_s {int dummy;}; /* for buggy compilers */
    (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
     match_head = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
+#elif defined(FAST_DEFLATE)
+#define INSERT_STRING(s, str, match_head) \
+   ((s->fast_match ? (s->ins_h = HASH4(s, s->window + (str))) : \
+                     UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)])), \
+    match_head = s->prev[(str) & s->w_mask] = s->head[s->ins_h], \
+    s->head[s->ins_h] = (Pos)(str))
 #else
 #define INSERT_STRING(s, str, match_head) \
    (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
@@ -277,13 +315,20 @@ int ZEXPORT deflateInit2_(strm, level, method, windowBits, memLevel, strategy,
     s->hash_size = 1 << s->hash_bits;
     s->hash_mask = s->hash_size - 1;
     s->hash_shift =  ((s->hash_bits+MIN_MATCH-1)/MIN_MATCH);
+#ifdef FAST_DEFLATE
+    s->fast_match = (zlibCpuFeatures() & Z_FAST_DEFLATE) != 0;
+#else
+    s->fast_match = 0;
+#endif
 
-    s->window = (Bytef *) ZALLOC(strm, s->w_size, 2*sizeof(Byte));
+    s->window = (Bytef *) ZALLOC(strm, 2*s->w_size + WIN_PADDING, sizeof(Byte));
     s->prev   = (Posf *)  ZALLOC(strm, s->w_size, sizeof(Pos));
     memset(s->prev, 0, s->w_size*sizeof(Pos)); /* XXX Zero out for emscripten, to avoid SAFE_HEAP warnings */
     s->head   = (Posf *)  ZALLOC(strm, s->hash_size, sizeof(Pos));
 
     s->high_water = 0;      /* nothing written to s->window yet */
+    if (s->window != Z_NULL)
+        zmemzero(s->window + 2*s->w_size, WIN_PADDING);
 
     s->lit_bufsize = 1 << (memLevel + 6); /* 16K elements by default */
 
@@ -341,6 +386,13 @@ int ZEXPORT deflateSetDictionary (strm, dictionary, dictLength)
      * s->lookahead stays null, so s->ins_h will be recomputed at the next
      * call of fill_window.
      */
+#ifdef FAST_DEFLATE
+    if (s->fast_match) {
+        /* the hash of the last string would read past the dictionary */
+        insert_strings(s, 0, length - MIN_MATCH);
+        return Z_OK;
+    }
+#endif
     s->ins_h = s->window[0];
     UPDATE_HASH(s, s->ins_h, s->window[1]);
     for (n = 0; n <= length - MIN_MATCH; n++) {
@@ -954,7 +1006,7 @@ int ZEXPORT deflateCopy (dest, source)
     zmemcpy(ds, ss, sizeof(deflate_state));
     ds->strm = dest;
 
-    ds->window = (Bytef *) ZALLOC(dest, ds->w_size, 2*sizeof(Byte));
+    ds->window = (Bytef *) ZALLOC(dest, 2*ds->w_size + WIN_PADDING, sizeof(Byte));
     ds->prev   = (Posf *)  ZALLOC(dest, ds->w_size, sizeof(Pos));
     memset(ds->prev, 0, ds->w_size*sizeof(Pos)); /* XXX Zero out for emscripten, to avoid SAFE_HEAP warnings */
     ds->head   = (Posf *)  ZALLOC(dest, ds->hash_size, sizeof(Pos));
@@ -967,7 +1019,7 @@ int ZEXPORT deflateCopy (dest, source)
         return Z_MEM_ERROR;
     }
     /* following zmemcpy do not work for 16-bit MSDOS */
-    zmemcpy(ds->window, ss->window, ds->w_size * 2 * sizeof(Byte));
+    zmemcpy(ds->window, ss->window, ds->w_size * 2 * sizeof(Byte) + WIN_PADDING);
     zmemcpy(ds->prev, ss->prev, ds->w_size * sizeof(Pos));
     zmemcpy(ds->head, ss->head, ds->hash_size * sizeof(Pos));
     zmemcpy(ds->pending_buf, ss->pending_buf, (uInt)ds->pending_buf_size);
@@ -1094,6 +1146,10 @@ local uInt longest_match(s, cur_match)
     register Byte scan_end   = scan[best_len];
 #endif
 
+#ifdef FAST_DEFLATE
+    if (s->fast_match) return longest_match_wide(s, cur_match);
+#endif
+
     /* The code is optimized for HASH_BITS >= 8 and MAX_MATCH-2 multiple of 16.
      * It is easy to get rid of this optimization if necessary.
      */
@@ -1207,6 +1263,105 @@ local uInt longest_match(s, cur_match)
 }
 #endif /* ASMV */
 
+#ifdef FAST_DEFLATE
+/* ===========================================================================
+ * Insert the count strings from str on in the dictionary, like that many
+ * INSERT_STRING calls with fast_match set. The hash of a string does not
+ * depend on the previous one, so the four hashes of a group are computed
+ * from a single 8 byte load before the strings are linked in.
+ * IN assertion: the 4 bytes of every string are in the window.
+ */
+local void insert_strings(s, str, count)
+    deflate_state *s;
+    uInt str;
+    uInt count;
+{
+    Bytef *window = s->window;
+    Posf *prev = s->prev;
+    Posf *head = s->head;
+    uInt wmask = s->w_mask;
+    int shift = 32 - s->hash_bits;
+    unsigned long long bytes;
+    uInt h0, h1, h2, h3;
+
+    while (count >= 4) {
+        zmemcpy(&bytes, window + str, sizeof(bytes));
+        h0 = ((unsigned)bytes * 2654435761U) >> shift;
+        h1 = ((unsigned)(bytes >> 8) * 2654435761U) >> shift;
+        h2 = ((unsigned)(bytes >> 16) * 2654435761U) >> shift;
+        h3 = ((unsigned)(bytes >> 24) * 2654435761U) >> shift;
+        prev[str & wmask] = head[h0];
+        head[h0] = (Pos)str;
+        prev[(str + 1) & wmask] = head[h1];
+        head[h1] = (Pos)(str + 1);
+        prev[(str + 2) & wmask] = head[h2];
+        head[h2] = (Pos)(str + 2);
+        prev[(str + 3) & wmask] = head[h3];
+        head[h3] = (Pos)(str + 3);
+        str += 4;
+        count -= 4;
+    }
+    while (count--) {
+        h0 = HASH4(s, window + str);
+        prev[str & wmask] = head[h0];
+        head[h0] = (Pos)str;
+        str++;
+    }
+}
+
+/* ===========================================================================
+ * Same as longest_match() for streams with fast_match set. Since strings of
+ * one hash chain do not necessarily share their first bytes, the first two
+ * bytes of a candidate are checked along with the two that end a longer
+ * match before compare258() looks at all of it.
+ */
+local uInt longest_match_wide(s, cur_match)
+    deflate_state *s;
+    IPos cur_match;                             /* current match */
+{
+    unsigned chain_length = s->max_chain_length;/* max hash chain length */
+    Bytef *scan = s->window + s->strstart;      /* current string */
+    Bytef *match;                               /* matched string */
+    uInt len;                                   /* length of current match */
+    uInt best_len = s->prev_length;             /* best match length so far */
+    uInt nice_match = s->nice_match;            /* stop if match long enough */
+    IPos limit = s->strstart > (IPos)MAX_DIST(s) ?
+        s->strstart - (IPos)MAX_DIST(s) : NIL;
+    Posf *prev = s->prev;
+    uInt wmask = s->w_mask;
+    ush scan_start = load16(scan);
+    ush scan_end   = load16(scan + best_len - 1);
+
+    if (s->prev_length >= s->good_match) {
+        chain_length >>= 2;
+    }
+    if (nice_match > s->lookahead) nice_match = s->lookahead;
+
+    Assert((ulg)s->strstart <= s->window_size-MIN_LOOKAHEAD, "need lookahead");
+
+    do {
+        Assert(cur_match < s->strstart, "no future");
+        match = s->window + cur_match;
+
+        if (load16(match + best_len - 1) != scan_end ||
+            load16(match) != scan_start) continue;
+
+        len = compare258(scan, match);
+        if (len > best_len) {
+            s->match_start = cur_match;
+            best_len = len;
+            if (len >= nice_match) break;
+            scan_end = load16(scan + best_len - 1);
+        }
+    } while ((cur_match = prev[cur_match & wmask]) > limit
+             && --chain_length != 0);
+
+    if (best_len <= s->lookahead) return best_len;
+    return s->lookahead;
+}
+
+#endif /* FAST_DEFLATE */
+
 #else /* FASTEST */
 
 /* ---------------------------------------------------------------------------
@@ -1571,6 +1726,15 @@ local block_state deflate_fast(s, flush)
             /* Insert new strings in the hash table only if the match length
              * is not too large. This saves time but degrades compression.
              */
+#ifdef FAST_DEFLATE
+            if (s->fast_match && s->match_length <= s->max_insert_length &&
+                s->lookahead >= MIN_MATCH) {
+                /* string at strstart already in table */
+                insert_strings(s, s->strstart + 1, s->match_length - 1);
+                s->strstart += s->match_length;
+                s->match_length = 0;
+            } else
+#endif
 #ifndef FASTEST
             if (s->match_length <= s->max_insert_length &&
                 s->lookahead >= MIN_MATCH) {
@@ -1692,6 +1856,17 @@ local block_state deflate_slow(s, flush)
              */
             s->lookahead -= s->prev_length-1;
             s->prev_length -= 2;
+#ifdef FAST_DEFLATE
+            if (s->fast_match) {
+                if (s->strstart + s->prev_length <= max_insert)
+                    insert_strings(s, s->strstart + 1, s->prev_length);
+                else if (s->strstart < max_insert)
+                    insert_strings(s, s->strstart + 1,
+                                   max_insert - s->strstart);
+                s->strstart += s->prev_length;
+                s->prev_length = 0;
+            } else
+#endif
             do {
                 if (++s->strstart <= max_insert) {
                     INSERT_STRING(s, s->strstart, hash_head);
@@ -145,6 +145,11 @@ typedef struct internal_state {
      *   hash_shift * MIN_MATCH >= hash_bits
      */
 
+    int   fast_match;
+    /* Nonzero if ins_h is the FAST_DEFLATE hash of the 4 bytes at the string
+     * instead of the running hash, and longest_match() is the wide one.
+     */
+
     long block_start;
     /* Window position at the beginning of the current output block. Gets
      * negative when the window is moved backwards.
@@ -289,6 +294,10 @@ typedef struct internal_state {
 /* Number of bytes after end of data in window to initialize in order to avoid
    memory checker errors from longest match routines */
 
+#define WIN_PADDING 16
+/* Number of bytes allocated after the window, since the wide longest match
+   routine compares MAX_MATCH bytes in blocks of up to 16 bytes */
+
         /* in trees.c */
 void ZLIB_INTERNAL _tr_init OF((deflate_state *s));
 int ZLIB_INTERNAL _tr_tally OF((deflate_state *s, unsigned dist, unsigned lc));
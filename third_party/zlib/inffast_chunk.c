@@ -0,0 +1,343 @@
+/* inffast_chunk.c -- fast decoding with a 64 bit bit buffer and wide copies
+ * Copyright (C) 1995-2008, 2010 Mark Adler
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "zutil.h"
+#include "inftrees.h"
+#include "inflate.h"
+#include "inffast_chunk.h"
+#include "cpu_features.h"
+
+#ifdef FAST_INFLATE
+
+/* Matches are copied in chunks of 16 bytes with SSE2 or simd128, and of 8
+   bytes with 64 bit loads and stores otherwise.
+ */
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define CHUNK_SIZE 16
+typedef __m128i chunk_t;
+#  define loadchunk(p) _mm_loadu_si128((const __m128i *)(p))
+#  define storechunk(p, c) _mm_storeu_si128((__m128i *)(p), (c))
+#elif defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#  define CHUNK_SIZE 16
+typedef v128_t chunk_t;
+#  define loadchunk(p) wasm_v128_load(p)
+#  define storechunk(p, c) wasm_v128_store((p), (c))
+#else
+#  define CHUNK_SIZE 8
+typedef unsigned long long chunk_t;
+
+local chunk_t loadchunk OF((const unsigned char FAR *p));
+local void storechunk OF((unsigned char FAR *p, chunk_t c));
+
+local chunk_t loadchunk(p)
+const unsigned char FAR *p;
+{
+    chunk_t c;
+    zmemcpy(&c, p, sizeof(c));
+    return c;
+}
+
+local void storechunk(p, c)
+unsigned char FAR *p;
+chunk_t c;
+{
+    zmemcpy(p, &c, sizeof(c));
+}
+#endif
+
+local unsigned char FAR *chunkcopy OF((unsigned char FAR *out,
+                                       const unsigned char FAR *from,
+                                       unsigned len));
+local unsigned char FAR *chunkcopy_lapped OF((unsigned char FAR *out,
+                                              unsigned dist, unsigned len));
+
+/*
+   Copy len > 0 bytes from from to out, which do not overlap, and return
+   out + len. Up to CHUNK_SIZE - 1 bytes after the ends of both are read and
+   written as well.
+ */
+local unsigned char FAR *chunkcopy(out, from, len)
+unsigned char FAR *out;
+const unsigned char FAR *from;
+unsigned len;
+{
+    unsigned char FAR *end = out + len;
+
+    do {
+        storechunk(out, loadchunk(from));
+        out += CHUNK_SIZE;
+        from += CHUNK_SIZE;
+    } while (out < end);
+    return end;
+}
+
+/*
+   Copy len > 0 bytes from dist bytes back in the output to out, where the
+   source can overlap the bytes that are written, and return out + len. Up to
+   CHUNK_SIZE - 1 bytes after out + len are written as well.
+
+   A chunk can only be copied once the bytes it reads are written, which is
+   always the case for distances of at least CHUNK_SIZE. A shorter distance
+   repeats the same dist bytes, so the first multiple of dist that is at
+   least CHUNK_SIZE bytes long is written one byte at a time, and the rest
+   is copied in chunks from that far back.
+ */
+local unsigned char FAR *chunkcopy_lapped(out, dist, len)
+unsigned char FAR *out;
+unsigned dist;
+unsigned len;
+{
+    unsigned char FAR *end = out + len;
+    const unsigned char FAR *from = out - dist;
+    unsigned period;
+
+    if (dist < CHUNK_SIZE) {
+        period = dist;
+        while (period < CHUNK_SIZE)
+            period += dist;
+        if (len <= period) {
+            do {
+                *out++ = *from++;
+            } while (--len);
+            return end;
+        }
+        len = period;
+        do {
+            *out++ = *from++;
+        } while (--len);
+        from = out - period;
+    }
+    do {
+        storechunk(out, loadchunk(from));
+        out += CHUNK_SIZE;
+        from += CHUNK_SIZE;
+    } while (out < end);
+    return end;
+}
+
+/*
+   Same as inflate_fast(), with the speedups below that need more input and
+   output space, see inffast_chunk.h. inflate() only calls it when
+   state->chunked is set.
+
+    - The bit buffer is 64 bits wide and refilled with one unaligned 8 byte
+      load of as many whole bytes as fit. With at least 48 bits after the
+      refill at the top of the loop, a whole length/distance pair can be
+      decoded without checking the number of bits again.
+
+    - Matches are copied with chunkcopy() and chunkcopy_lapped(). They can
+      write up to CHUNK_SIZE - 1 bytes past the match, which the following
+      output overwrites. The window is allocated with WINDOW_PADDING extra
+      bytes for the chunks that read past its end.
+
+   This needs an unaligned little endian 8 byte load, so FAST_INFLATE is only
+   defined for little endian builds with GCC or clang.
+ */
+void ZLIB_INTERNAL inflate_fast_chunk(strm, start)
+z_streamp strm;
+unsigned start;         /* inflate()'s starting value for strm->avail_out */
+{
+    struct inflate_state FAR *state;
+    unsigned char FAR *in;      /* local strm->next_in */
+    unsigned char FAR *last;    /* while in < last, enough input available */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, enough space available */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned wnext;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    unsigned long long hold;    /* local strm->hold, 64 bits wide */
+    unsigned long long bytes;   /* next 8 input bytes for the refill */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code here;                  /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_INPUT - 1));
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    end = out + (strm->avail_out - (INFLATE_FAST_MIN_OUTPUT - 1));
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    wnext = state->wnext;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        if (bits < 48) {
+            zmemcpy(&bytes, in, sizeof(bytes));
+            hold |= bytes << bits;
+            in += (63 - bits) >> 3;
+            bits += ((63 - bits) >> 3) << 3;
+        }
+        here = lcode[hold & lmask];
+      dolen:
+        op = (unsigned)(here.bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(here.op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, here.val >= 0x20 && here.val < 0x7f ?
+                    "inflate:         literal '%c'\n" :
+                    "inflate:         literal 0x%02x\n", here.val));
+            *out++ = (unsigned char)(here.val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(here.val);
+            op &= 15;                           /* number of extra bits */
+            if (op) {
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= op;
+            }
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            here = dcode[hold & dmask];
+          dodist:
+            op = (unsigned)(here.bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(here.op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(here.val);
+                op &= 15;                       /* number of extra bits */
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        if (state->sane) {
+                            strm->msg =
+                                (char *)"invalid distance too far back";
+                            state->mode = BAD;
+                            break;
+                        }
+#ifdef INFLATE_ALLOW_INVALID_DISTANCE_TOOFAR_ARRR
+                        if (len <= op - whave) {
+                            do {
+                                *out++ = 0;
+                            } while (--len);
+                            continue;
+                        }
+                        len -= op - whave;
+                        do {
+                            *out++ = 0;
+                        } while (--op > whave);
+                        if (op == 0) {
+                            out = chunkcopy_lapped(out, dist, len);
+                            continue;
+                        }
+#endif
+                    }
+                    from = window;
+                    if (wnext == 0) {           /* very common case */
+                        from += wsize - op;
+                    }
+                    else if (wnext < op) {      /* wrap around window */
+                        from += wsize + wnext - op;
+                        op -= wnext;
+                        if (op < len) {         /* some from end of window */
+                            len -= op;
+                            out = chunkcopy(out, from, op);
+                            from = window;      /* then from its start */
+                            op = wnext;
+                        }
+                    }
+                    else {                      /* contiguous in window */
+                        from += wnext - op;
+                    }
+                    if (op < len) {             /* some from window */
+                        len -= op;
+                        out = chunkcopy(out, from, op);
+                        out = chunkcopy_lapped(out, dist, len);
+                    }
+                    else
+                        out = chunkcopy(out, from, len);
+                }
+                else                            /* copy direct from output */
+                    out = chunkcopy_lapped(out, dist, len);
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                here = dcode[here.val + (hold & ((1U << op) - 1))];
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            here = lcode[here.val + (hold & ((1U << op) - 1))];
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= (1U << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(in < last ?
+        (INFLATE_FAST_MIN_INPUT - 1) + (last - in) :
+        (INFLATE_FAST_MIN_INPUT - 1) - (in - last));
+    strm->avail_out = (unsigned)(out < end ?
+        (INFLATE_FAST_MIN_OUTPUT - 1) + (end - out) :
+        (INFLATE_FAST_MIN_OUTPUT - 1) - (out - end));
+    state->hold = (unsigned long)hold;
+    state->bits = bits;
+    return;
+}
+
+#endif /* FAST_INFLATE */
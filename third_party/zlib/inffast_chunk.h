@@ -0,0 +1,18 @@
+/* inffast_chunk.h -- header to use inffast_chunk.c
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+/* inflate_fast_chunk() refills its bit buffer with 8 byte loads, so it
+   needs 8 bytes of input instead of 6. It copies matches in chunks of up to
+   16 bytes that can end 15 bytes after the match, so it needs that much
+   more output space than the 258 bytes of the longest match.
+ */
+#define INFLATE_FAST_MIN_INPUT 8
+#define INFLATE_FAST_MIN_OUTPUT (258 + 15)
+
+void ZLIB_INTERNAL inflate_fast_chunk OF((z_streamp strm, unsigned start));
@@ -84,6 +84,8 @@
 #include "inftrees.h"
 #include "inflate.h"
 #include "inffast.h"
+#include "inffast_chunk.h"
+#include "cpu_features.h"
 
 #ifdef MAKEFIXED
 #  ifndef BUILDFIXED
@@ -190,6 +192,11 @@ int stream_size;
     Tracev((stderr, "inflate: allocated\n"));
     strm->state = (struct internal_state FAR *)state;
     state->window = Z_NULL;
+#ifdef FAST_INFLATE
+    state->chunked = (zlibCpuFeatures() & Z_FAST_INFLATE) != 0;
+#else
+    state->chunked = 0;
+#endif
     ret = inflateReset2(strm, windowBits);
     if (ret != Z_OK) {
         ZFREE(strm, state);
@@ -367,7 +374,7 @@ unsigned out;
     /* if it hasn't been done already, allocate space for the window */
     if (state->window == Z_NULL) {
         state->window = (unsigned char FAR *)
-                        ZALLOC(strm, 1U << state->wbits,
+                        ZALLOC(strm, (1U << state->wbits) + WINDOW_PADDING,
                                sizeof(unsigned char));
         if (state->window == Z_NULL) return 1;
     }
@@ -1004,6 +1011,17 @@ int flush;
         case LEN_:
             state->mode = LEN;
         case LEN:
+#ifdef FAST_INFLATE
+            if (state->chunked && have >= INFLATE_FAST_MIN_INPUT &&
+                left >= INFLATE_FAST_MIN_OUTPUT) {
+                RESTORE();
+                inflate_fast_chunk(strm, out);
+                LOAD();
+                if (state->mode == TYPE)
+                    state->back = -1;
+                break;
+            }
+#endif
             if (have >= 6 && left >= 258) {
                 RESTORE();
                 inflate_fast(strm, out);
@@ -1425,7 +1443,8 @@ z_streamp source;
     window = Z_NULL;
     if (state->window != Z_NULL) {
         window = (unsigned char FAR *)
-                 ZALLOC(source, 1U << state->wbits, sizeof(unsigned char));
+                 ZALLOC(source, (1U << state->wbits) + WINDOW_PADDING,
+                        sizeof(unsigned char));
         if (window == Z_NULL) {
             ZFREE(source, copy);
             return Z_MEM_ERROR;
@@ -117,6 +117,11 @@ struct inflate_state {
     unsigned short work[288];   /* work area for code table building */
     code codes[ENOUGH];         /* space for code tables */
     int sane;                   /* if false, allow invalid distance too far */
+    int chunked;                /* true to decode with inflate_fast_chunk() */
     int back;                   /* bits back of last unprocessed length/lit */
     unsigned was;               /* initial length of match */
 };
+
+/* Bytes allocated after the window, since the chunk copies of
+   inflate_fast_chunk() can read up to 15 bytes past the end of it */
+#define WINDOW_PADDING 16
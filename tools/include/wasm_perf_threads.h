@@ -0,0 +1,50 @@
+#ifndef __WASM_PERF_THREADS_H__
+#define __WASM_PERF_THREADS_H__
+
+#include "wasm_perf.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+  struct wasm_perf_thread_start {
+    void* (*start_routine)(void*);
+    void* arg;
+    uint64_t reference;
+  };
+
+  static void* wasm_perf_thread_trampoline(void* data) {
+    struct wasm_perf_thread_start start = *(struct wasm_perf_thread_start*)data;
+    free(data);
+    wasm_perf_mark_end("thread_startup", start.reference);
+    return start.start_routine(start.arg);
+  }
+
+  // Drop-in replacement for pthread_create() that records two intervals for the given reference:
+  // "thread_create" covers the pthread_create() call itself and "thread_startup" lasts until the
+  // start routine actually runs on the new thread. For Wasm the latter includes loading a worker
+  // unless one is available in the pre-spawned pool.
+  static inline int wasm_perf_pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start_routine)(void*), void* arg, uint64_t reference) {
+    struct wasm_perf_thread_start* start = (struct wasm_perf_thread_start*)malloc(sizeof(struct wasm_perf_thread_start));
+    int result;
+    if (start == NULL)
+      return EAGAIN;
+    start->start_routine = start_routine;
+    start->arg = arg;
+    start->reference = reference;
+    wasm_perf_mark_begin("thread_create", reference);
+    wasm_perf_mark_begin("thread_startup", reference);
+    result = pthread_create(thread, attr, wasm_perf_thread_trampoline, start);
+    wasm_perf_mark_end("thread_create", reference);
+    if (result != 0)
+      free(start);
+    return result;
+  }
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __WASM_PERF_THREADS_H__
@@ -1,9 +1,17 @@
+// Calls from worker threads are proxied to the main thread, which is where the wrapper installs the recorder.
 mergeInto(LibraryManager.library, {
   wasm_perf_ready: () => {},
+  wasm_perf_ready__proxy: 'sync',
   wasm_perf_done: () => {},
+  wasm_perf_done__proxy: 'sync',
   wasm_perf_mark_event: () => {},
+  wasm_perf_mark_event__proxy: 'sync',
   wasm_perf_mark_begin: () => {},
+  wasm_perf_mark_begin__proxy: 'sync',
   wasm_perf_mark_end: () => {},
+  wasm_perf_mark_end__proxy: 'sync',
   wasm_perf_record_progress: () => {},
+  wasm_perf_record_progress__proxy: 'sync',
   wasm_perf_record_relative_progress: () => {},
+  wasm_perf_record_relative_progress__proxy: 'sync',
 });
@@ -1,10 +1,22 @@
 #include "benchmark.h"
 
+#include <algorithm>
+#include <iterator>
+
 
 namespace wasm {
 namespace perf {
 
 
+EventRecorder& EventRecorder::operator += (const EventRecorder& other) {
+  std::vector<std::pair<size_t, std::string>> new_data;
+  new_data.reserve(data_.size() + other.data_.size());
+  std::merge(data_.begin(), data_.end(), other.data_.begin(), other.data_.end(), std::back_inserter(new_data));
+  data_ = std::move(new_data);
+  return *this;
+}
+
+
 ProgressRecorder& ProgressRecorder::operator += (const ProgressRecorder& other) {
   std::vector<DataPoint> new_data;
   new_data.reserve(data_.size() + other.data_.size());
@@ -18,9 +30,9 @@ ProgressRecorder& ProgressRecorder::operator += (const ProgressRecorder& other)
   size_t this_time_shift = 0;
   size_t other_time_shift = 0;
   if (start_time_ <= other.start_time_) {
-    other_time_shift = static_cast<size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(other.start_time_ - start_time_).count());
+    other_time_shift = static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(other.start_time_ - start_time_).count());
   } else {
-    this_time_shift = static_cast<size_t>(std::chrono::duration_cast<std::chrono::milliseconds>(start_time_ - other.start_time_).count());
+    this_time_shift = static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(start_time_ - other.start_time_).count());
     start_time_ = other.start_time_;
   }
 
@@ -99,6 +111,16 @@ ProgressRecorder::Analysis ProgressRecorder::analyze() const {
 }
 
 
+Benchmark& Benchmark::operator += (const Benchmark& other) {
+  event_recorder_ += other.event_recorder_;
+  for (const auto& interval_recorder : other.interval_recorders_)
+    interval_recorders_[interval_recorder.first] += interval_recorder.second;
+  for (const auto& progress_recorder : other.progress_recorders_)
+    progress_recorders_[progress_recorder.first] += progress_recorder.second;
+  return *this;
+}
+
+
 std::ostream& operator<<(std::ostream& os, const Benchmark& benchmark) {
   os << "[EVENTS]\n";
   for (const std::pair<size_t, std::string>& data_point : benchmark.event_recorder_.data_)
@@ -111,6 +133,9 @@ std::ostream& operator<<(std::ostream& os, const Benchmark& benchmark) {
   }
 
   for (const auto& progress_recorder : benchmark.progress_recorders_) {
+    // Work items that never made any progress, e.g. a stage that never ran, cannot be analyzed.
+    if (progress_recorder.second.data_.size() < 2)
+      continue;
     os << "\n[PROGRESS " << progress_recorder.first << "]\n";
 
     size_t last_time_stamp = 0;
@@ -21,6 +21,8 @@ class EventRecorder {
       data_.emplace_back(time_in_us, event_id);
     }
 
+    EventRecorder& operator += (const EventRecorder& other);
+
   private:
     struct DataPoint {
       size_t time;
@@ -51,6 +53,11 @@ class IntervalRecorder {
       }
     }
 
+    inline IntervalRecorder& operator += (const IntervalRecorder& other) {
+      data_.insert(data_.end(), other.data_.begin(), other.data_.end());
+      return *this;
+    }
+
   private:
     struct DataPoint {
       uint64_t numeric_id;
@@ -153,6 +160,10 @@ class Benchmark {
       return progress_recorders_[id];
     }
 
+    // Merges the records of another benchmark, e.g. of a concurrently running copy. Work on
+    // progress streams with the same id adds up.
+    Benchmark& operator += (const Benchmark& other);
+
   private:
     TimeKeeper time_keeper_;
     EventRecorder event_recorder_;
@@ -1,23 +1,25 @@
 #include "benchmark.h"
 
-#include <cstdio> 
+#include <cstdio>
+#include <cstring>
 #include <unistd.h> 
 #include <iostream>
 #include <fstream>
 #include <regex>
 #include <exception>
+#include <thread>
 #include <sys/wait.h>
 
 
 namespace {
 
 
-std::regex regex("^\\[WASM_PERF/([A-Z_]+)\\]\t([0-9]+)(?:\t([0-9.]+)(?:\t(.+))?)?$");
+std::regex regex("^\\[WASM_PERF/([A-Z_]+)\\]\t([0-9]+)(?:\t([0-9.]+))?(?:\t(.+))?$");
 
 class Arguments {
   public:
     Arguments(const int arg_count, char* const args[])
-      : help_(false), verbose_(false), record_runs_(false), runs_(1) {
+      : help_(false), verbose_(false), record_runs_(false), runs_(1), copies_(1) {
       size_t arg_index = 1;
       for (; arg_index < arg_count; ++arg_index) {
         if (args[arg_index][0] != '-') {
@@ -50,6 +52,18 @@ class Arguments {
           } else {
             throw std::invalid_argument("Missing argument after -r");
           }
+        } else if (strncmp(args[arg_index], "--copies", 9) == 0 || strncmp(args[arg_index], "-c", 3) == 0) {
+          ++arg_index;
+          if (arg_index < arg_count) {
+            char* end;
+            long long value = strtoll(args[arg_index], &end, 0);
+            if (*end != '\0' || value < 1)
+              throw std::invalid_argument("Invalid argument to -c");
+            else
+              copies_ = value;
+          } else {
+            throw std::invalid_argument("Missing argument after -c");
+          }
         } else {
           throw std::invalid_argument("Unexpected argument");
         }
@@ -90,6 +104,10 @@ class Arguments {
       return runs_;
     }
 
+    size_t getCopies() const {
+      return copies_;
+    }
+
   private:
     bool help_;
     bool verbose_;
@@ -97,6 +115,7 @@ class Arguments {
     std::vector<char*> args_;
     std::ofstream output_file_;
     size_t runs_;
+    size_t copies_;
 };
 
 
@@ -164,6 +183,68 @@ ssize_t parseOutput(wasm::perf::Benchmark& benchmark, std::FILE* const input, ss
 }
 
 
+// Runs the given number of copies of the command simultaneously. All copies are forked first and
+// then released together by closing the start pipe they are blocked on. Each copy's output is
+// parsed on its own thread into its own benchmark and the time shifts are carried over between
+// runs like for a single copy.
+void runCopies(const Arguments& args, std::vector<wasm::perf::Benchmark>& copies, std::vector<ssize_t>& time_shifts_in_us) {
+  int start_pipe[2];
+  if (pipe(start_pipe) < 0)
+    throw std::runtime_error("Could not create pipe");
+
+  std::vector<pid_t> pids;
+  std::vector<std::FILE*> inputs;
+  for (size_t copy = 0; copy < copies.size(); ++copy) {
+    int fd[2];
+    if (pipe(fd) < 0)
+      throw std::runtime_error("Could not create pipe");
+    pid_t pid = fork();
+    if (pid == 0) {
+      // Wait for the parent to close the start pipe before executing the command.
+      dup2(fd[1], STDOUT_FILENO);
+      close(fd[0]);
+      close(fd[1]);
+      close(start_pipe[1]);
+      char start;
+      while (read(start_pipe[0], &start, 1) > 0) {}
+      close(start_pipe[0]);
+      execvp(args[0], args);
+      _exit(127);
+    }
+    close(fd[1]);
+    pids.push_back(pid);
+    inputs.push_back(fdopen(fd[0], "r"));
+  }
+  close(start_pipe[0]);
+  close(start_pipe[1]);
+
+  std::vector<std::exception_ptr> errors(copies.size());
+  std::vector<std::thread> threads;
+  for (size_t copy = 0; copy < copies.size(); ++copy) {
+    threads.emplace_back([&, copy]() {
+      try {
+        time_shifts_in_us[copy] = parseOutput(copies[copy], inputs[copy], time_shifts_in_us[copy], args.getVerbose());
+      } catch (...) {
+        errors[copy] = std::current_exception();
+      }
+    });
+  }
+  for (size_t copy = 0; copy < copies.size(); ++copy) {
+    threads[copy].join();
+    int status = -1;
+    waitpid(pids[copy], &status, 0);
+    status = WEXITSTATUS(status);
+    if (status != 0)
+      std::cerr << "Copy " << copy << " exited with status " << status << std::endl;
+    std::fclose(inputs[copy]);
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+
 } // namespace
 
 
@@ -173,7 +254,7 @@ int main(const int argc, char* const argv[]) {
 
     // Check number of command line parameters.
     if (args.help()) {
-      std::cerr << "SYNTAX - " << argv[0] << " [--verbose|-v] [--record-runs|-R] [-o <output_file>] [-r <runs>] [--] [<command> [<args> ...]]" << std::endl;
+      std::cerr << "SYNTAX - " << argv[0] << " [--verbose|-v] [--record-runs|-R] [-o <output_file>] [-r <runs>] [--copies|-c <copies>] [--] [<command> [<args> ...]]" << std::endl;
       return 0;
     }
 
@@ -186,6 +267,21 @@ int main(const int argc, char* const argv[]) {
       if (args.getRecordRuns())
         benchmark.getProgressRecorder("runs").submitAccumulatedWork(benchmark.getTimeStamp(), 1);
       args.getOutput() << benchmark;
+    } else if (args.getCopies() > 1) {
+      // Throughput under contention: the progress of all copies adds up in the output.
+      wasm::perf::Benchmark benchmark;
+      std::vector<wasm::perf::Benchmark> copies(args.getCopies());
+      std::vector<ssize_t> time_shifts_in_us(args.getCopies(), 0);
+      if (args.getRecordRuns())
+        benchmark.getProgressRecorder("runs").submitAccumulatedWork(benchmark.getTimeStamp(), 0);
+      for (size_t run_index = 0; run_index < args.getRuns(); ++run_index) {
+        runCopies(args, copies, time_shifts_in_us);
+        if (args.getRecordRuns())
+          benchmark.getProgressRecorder("runs").submitAccumulatedWork(benchmark.getTimeStamp(), (run_index + 1) * args.getCopies());
+      }
+      for (const wasm::perf::Benchmark& copy : copies)
+        benchmark += copy;
+      args.getOutput() << benchmark;
     } else {
       wasm::perf::Benchmark benchmark;
       if (args.getRecordRuns())
@@ -15,12 +15,12 @@ wasm::perf::TimeKeeper time_keeper;
 extern "C" {
 
 void wasm_perf_ready() {
-  printf("[WASM_PERF/READY] %zu\n", time_keeper.getTimeStamp());
+  printf("[WASM_PERF/READY]\t%zu\n", time_keeper.getTimeStamp());
   fflush(stdout);
 }
 
 void wasm_perf_done() {
-  printf("[WASM_PERF/DONE] %zu\n", time_keeper.getTimeStamp());
+  printf("[WASM_PERF/DONE]\t%zu\n", time_keeper.getTimeStamp());
   fflush(stdout);
 }
 
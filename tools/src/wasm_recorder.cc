@@ -8,6 +8,15 @@ namespace {
 wasm::perf::Benchmark benchmark;
 ssize_t time_shift_in_us = 0;
 
+// Record kinds submitted by the buffered bridge in wrapper.js.
+enum BridgeRecord {
+  kBridgeEvent = 0,
+  kBridgeBegin = 1,
+  kBridgeEnd = 2,
+  kBridgeProgress = 3,
+  kBridgeRelativeProgress = 4
+};
+
 } // namespace
 
 
@@ -40,4 +49,31 @@ extern "C" {
   void wasm_perf_record_relative_progress(const char* work_item, float rel_progress) {
     benchmark.getProgressRecorder(work_item).submitWorkPackage(benchmark.getTimeStamp() + time_shift_in_us, rel_progress);
   }
+
+  // The buffered bridge keeps records on the JS side while the benchmark runs and submits them
+  // later with time stamps taken from this clock.
+  double EMSCRIPTEN_KEEPALIVE wasm_perf_bridge_time_stamp() {
+    return static_cast<double>(benchmark.getTimeStamp());
+  }
+
+  void EMSCRIPTEN_KEEPALIVE wasm_perf_bridge_submit(int kind, double time_in_us, const char* id, double value) {
+    const size_t time = static_cast<size_t>(time_in_us) + time_shift_in_us;
+    switch (kind) {
+      case kBridgeEvent:
+        benchmark.getEventRecorder().submit(time, id);
+        break;
+      case kBridgeBegin:
+        benchmark.getIntervalRecorder(id).submitBegin(time, static_cast<uint64_t>(value));
+        break;
+      case kBridgeEnd:
+        benchmark.getIntervalRecorder(id).submitEnd(time, static_cast<uint64_t>(value));
+        break;
+      case kBridgeProgress:
+        benchmark.getProgressRecorder(id).submitAccumulatedWork(time, value);
+        break;
+      case kBridgeRelativeProgress:
+        benchmark.getProgressRecorder(id).submitWorkPackage(time, value);
+        break;
+    }
+  }
 }
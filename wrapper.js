@@ -5,9 +5,10 @@
 if ((typeof process !== 'undefined') && (process.release.name === 'node')) {
   global.recorder_js = `${process.argv[2]}.mjs`;
   global.wasm_js = `${process.argv[3]}.mjs`;
-  global.argv = `${process.argv.slice(6)}`;
+  global.argv = process.argv.slice(7);
   global.runs = parseInt(process.argv[4], 10);
   global.verbose = (process.argv[5] == 'true');
+  global.bridge = process.argv[6];
   global.print = console.log;
   global.printErr = console.error;
   global.quit = process.exit;
@@ -33,6 +34,8 @@ if ((typeof process !== 'undefined') && (process.release.name === 'node')) {
 
 var global_recorder;
 var global_instance;
+var flush_bridge = () => {};
+const bridge_mode = typeof bridge !== 'undefined' ? bridge : 'glue';
 
 function generate_glue_code(function_name) {
   const exported_function = global_recorder['_wasm_perf_' + function_name];
@@ -49,8 +52,111 @@ function generate_glue_code(function_name) {
 }
 
 
+// Lower overhead alternative to generate_glue_code: records go into a Float64Array and are only
+// submitted to the recorder, with their original time stamps, once the buffer is full or the
+// benchmark is done. Strings are decoded once per distinct pointer and afterwards only compared.
+function generate_buffered_bridge(recorder) {
+  const capacity = 1 << 16;
+  const records = new Float64Array(4 * capacity);
+  let count = 0;
+  const strings = [];
+  const string_bytes = [];
+  const string_ids = new Map();
+  const decoder = typeof TextDecoder !== 'undefined' ? new TextDecoder() : null;
+  const time_offset = recorder._wasm_perf_bridge_time_stamp() - 1000 * performance.now();
+
+  const intern = pointer => {
+    const heap = new Uint8Array(global_instance.HEAP8.buffer);
+    let id = string_ids.get(pointer);
+    if (id !== undefined) {
+      const bytes = string_bytes[id];
+      let pos = 0;
+      while (pos < bytes.length && heap[pointer + pos] == bytes[pos])
+        ++pos;
+      if (pos == bytes.length && heap[pointer + pos] == 0)
+        return id;
+    }
+    let length = 0;
+    while (heap[pointer + length] != 0)
+      ++length;
+    const bytes = heap.slice(pointer, pointer + length);
+    id = strings.length;
+    strings.push(decoder !== null ? decoder.decode(bytes) : String.fromCharCode.apply(null, bytes));
+    string_bytes.push(bytes);
+    string_ids.set(pointer, id);
+    return id;
+  };
+
+  const flush = () => {
+    for (let index = 0; index < 4 * count; index += 4)
+      recorder.ccall('wasm_perf_bridge_submit', 'void', ['number', 'number', 'string', 'number'], [records[index], records[index + 1], strings[records[index + 2]], records[index + 3]]);
+    count = 0;
+  };
+
+  const submit = (kind, pointer, value) => {
+    const time = 1000 * performance.now() + time_offset;
+    const index = 4 * count;
+    records[index] = kind;
+    records[index + 1] = time;
+    records[index + 2] = intern(pointer);
+    records[index + 3] = value;
+    if (++count == capacity)
+      flush();
+  };
+
+  // 64 bit references arrive either as BigInt or legalized into two 32 bit halves.
+  const reference = (low, high) => typeof low === 'bigint' ? Number(low) : (low >>> 0) + (high >>> 0) * 4294967296;
+
+  return {
+    mark_event: pointer => submit(0, pointer, 0),
+    mark_begin: (pointer, low, high) => submit(1, pointer, reference(low, high)),
+    mark_end: (pointer, low, high) => submit(2, pointer, reference(low, high)),
+    record_progress: (pointer, progress) => submit(3, pointer, progress),
+    record_relative_progress: (pointer, progress) => submit(4, pointer, progress),
+    flush: flush
+  };
+}
+
+
+// Stand-in for the recorder module that prints records in the format of pipe_out.cc instead, so that
+// the native recorder can parse the output of several engine processes running side by side. It
+// provides the parts of the Emscripten module interface that are used in here.
+function create_pipe_out_recorder() {
+  const write = (kind, ...fields) => print([`[WASM_PERF/${kind}]`, Math.round(1000 * performance.now()), ...fields].join('\t'));
+  const functions = {
+    wasm_perf_ready: () => write('READY'),
+    wasm_perf_done: () => write('DONE'),
+    wasm_perf_mark_event: event => write('EVENT', event),
+    wasm_perf_mark_begin: (event, reference) => write('BEGIN', reference, event),
+    wasm_perf_mark_end: (event, reference) => write('END', reference, event),
+    wasm_perf_record_progress: (work_item, progress) => write('PROGRESS', progress.toFixed(6), work_item),
+    wasm_perf_record_relative_progress: (work_item, progress) => write('REL_PROGRESS', progress.toFixed(6), work_item)
+  };
+  const recorder = {ccall: (name, return_type, argument_types, args) => functions[name](...args)};
+  for (const name in functions)
+    recorder['_' + name] = functions[name];
+  return recorder;
+}
+
+// Glue for create_pipe_out_recorder(): only the strings need to be read from the benchmark's heap.
+function generate_pipe_out_glue_code(function_name) {
+  const recorder_function = global_recorder['_wasm_perf_' + function_name];
+  return function (pointer, ...args) {
+    let event = '';
+    for (let pos = pointer; global_instance.HEAP8[pos] != 0; ++pos)
+      event += String.fromCharCode(global_instance.HEAP8[pos] & 0xff);
+    // 64 bit references arrive either as BigInt or legalized into two 32 bit halves.
+    if (typeof args[0] === 'bigint')
+      args = [Number(args[0])];
+    else if (args.length == 2)
+      args = [(args[0] >>> 0) + (args[1] >>> 0) * 4294967296];
+    recorder_function(event, ...args);
+  }
+}
+
+
 const benchmark = Promise.all([
-  import(recorder_js).then(({default: recorder}) =>
+  (bridge_mode == 'pipe_out' ? Promise.resolve(create_pipe_out_recorder()) : import(recorder_js).then(({default: recorder}) =>
     recorder({
       print: print,
       locateFile: (path, prefix) => recorder_js.substring(0, recorder_js.length - 4) + '.wasm',
@@ -58,34 +164,54 @@ const benchmark = Promise.all([
         throw `Abnormal program termination with status ${status}`;
       }
     })
-  ).then(recorder => {
+  )).then(recorder => {
     global_recorder = recorder;
     _wasm_perf_ready = global_recorder._wasm_perf_ready;
-    _wasm_perf_done = global_recorder._wasm_perf_done;
-    _wasm_perf_mark_event = generate_glue_code('mark_event');
-    _wasm_perf_mark_begin = generate_glue_code('mark_begin');
-    _wasm_perf_mark_end = generate_glue_code('mark_end');
-    _wasm_perf_record_progress = generate_glue_code('record_progress');
-    _wasm_perf_record_relative_progress = generate_glue_code('record_relative_progress');
+    if (bridge_mode == 'pipe_out') {
+      _wasm_perf_done = global_recorder._wasm_perf_done;
+      _wasm_perf_mark_event = generate_pipe_out_glue_code('mark_event');
+      _wasm_perf_mark_begin = generate_pipe_out_glue_code('mark_begin');
+      _wasm_perf_mark_end = generate_pipe_out_glue_code('mark_end');
+      _wasm_perf_record_progress = generate_pipe_out_glue_code('record_progress');
+      _wasm_perf_record_relative_progress = generate_pipe_out_glue_code('record_relative_progress');
+    } else if (bridge_mode == 'buffered') {
+      const buffered_bridge = generate_buffered_bridge(recorder);
+      flush_bridge = buffered_bridge.flush;
+      _wasm_perf_done = () => {
+        flush_bridge();
+        global_recorder._wasm_perf_done();
+      };
+      _wasm_perf_mark_event = buffered_bridge.mark_event;
+      _wasm_perf_mark_begin = buffered_bridge.mark_begin;
+      _wasm_perf_mark_end = buffered_bridge.mark_end;
+      _wasm_perf_record_progress = buffered_bridge.record_progress;
+      _wasm_perf_record_relative_progress = buffered_bridge.record_relative_progress;
+    } else {
+      _wasm_perf_done = global_recorder._wasm_perf_done;
+      _wasm_perf_mark_event = generate_glue_code('mark_event');
+      _wasm_perf_mark_begin = generate_glue_code('mark_begin');
+      _wasm_perf_mark_end = generate_glue_code('mark_end');
+      _wasm_perf_record_progress = generate_glue_code('record_progress');
+      _wasm_perf_record_relative_progress = generate_glue_code('record_relative_progress');
+    }
 
     // Install monkey patched WebAssembly methods with markers.
     let wasm_compile_count = 0;
     let wasm_instantiate_count = 0;
     const wasm_compile = WebAssembly.compile;
     const wasm_instantiate = WebAssembly.instantiate;
+    // The intervals end once the returned promise settles, not when the call returns.
     WebAssembly.compile = function (...args) {
-      recorder.ccall('wasm_perf_mark_begin', 'void', ['string', 'int'], ['WebAssembly.compile', wasm_compile_count]);
-      const result = wasm_compile.apply(this, args);
-      recorder.ccall('wasm_perf_mark_end', 'void', ['string', 'int'], ['WebAssembly.compile', wasm_compile_count]);
-      ++wasm_compile_count;
-      return result;
+      const count = wasm_compile_count++;
+      recorder.ccall('wasm_perf_mark_begin', 'void', ['string', 'int'], ['WebAssembly.compile', count]);
+      return wasm_compile.apply(this, args).finally(() =>
+        recorder.ccall('wasm_perf_mark_end', 'void', ['string', 'int'], ['WebAssembly.compile', count]));
     };
     WebAssembly.instantiate = function (...args) {
-      recorder.ccall('wasm_perf_mark_begin', 'void', ['string', 'int'], ['WebAssembly.instantiate', wasm_instantiate_count]);
-      const result = wasm_instantiate.apply(this, args);
-      recorder.ccall('wasm_perf_mark_end', 'void', ['string', 'int'], ['WebAssembly.instantiate', wasm_instantiate_count]);
-      ++wasm_instantiate_count;
-      return result;
+      const count = wasm_instantiate_count++;
+      recorder.ccall('wasm_perf_mark_begin', 'void', ['string', 'int'], ['WebAssembly.instantiate', count]);
+      return wasm_instantiate.apply(this, args).finally(() =>
+        recorder.ccall('wasm_perf_mark_end', 'void', ['string', 'int'], ['WebAssembly.instantiate', count]));
     }
     recorder._wasm_perf_ready();
     return recorder;
@@ -93,23 +219,32 @@ const benchmark = Promise.all([
     module
   )
 ]).then(async ([recorder, module]) => {
+  // For pthreads builds this includes spawning and loading the pre-allocated worker pool.
+  recorder.ccall('wasm_perf_mark_begin', 'void', ['string', 'int'], ['module_init', 0]);
   return module({
     locateFile: (path, prefix) => wasm_js.substring(0, wasm_js.length - 4) + '.wasm',
+    mainScriptUrlOrBlob: wasm_js,
+    recorder: recorder,
     print: verbose ? printErr : text => {},
     printErr: print,
     onAbort: status => {
       throw `Abnormal program termination with status ${status}`;
     },
     noInitialRun: true
-  }).then(instance => [recorder, instance]);
-}).then(([recorder, instance]) => {
+  }).then(instance => {
+    recorder.ccall('wasm_perf_mark_end', 'void', ['string', 'int'], ['module_init', 0]);
+    return [recorder, instance];
+  });
+}).then(async ([recorder, instance]) => {
   global_instance = instance;
   recorder.ccall('wasm_perf_mark_event', 'void', ['string'], ['instantiated']);
   recorder.ccall('wasm_perf_record_progress', 'void', ['string', 'float'], ['runs', 0]);
   for (let run = 0; run < runs; ++run) {
-    instance.callMain(argv);
+    // Benchmarks driven from JS may return a promise.
+    await instance.callMain(argv);
     recorder.ccall('wasm_perf_record_progress', 'void', ['string', 'float'], ['runs', run + 1]);
   }
+  flush_bridge();
   recorder._wasm_perf_done();
   quit(0);
 }).catch(error => {